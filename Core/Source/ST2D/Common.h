@@ -13,33 +13,43 @@
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <limits>
+#include <numbers>
+
 namespace ST
 {
 	using Index = uint32_t;
+
+	//define ST_DOUBLE_PRECISION, e.g. by cmake option of the same name, for large world coordinates
+#ifdef ST_DOUBLE_PRECISION
+	using real = double;
+#else
 	using real = float;
+#endif
 
 	namespace Constant
 	{
 		constexpr unsigned int SimplexMax = 8;
 		constexpr unsigned int CCDMaxIterations = 20;
-		constexpr real Epsilon = FLT_EPSILON;
-		constexpr real Max = FLT_MAX;
-		constexpr real PositiveMin = FLT_MIN;
+		constexpr real Epsilon = std::numeric_limits<real>::epsilon();
+		constexpr real Max = std::numeric_limits<real>::max();
+		constexpr real PositiveMin = std::numeric_limits<real>::min();
 		constexpr real NegativeMin = -Max;
-		constexpr real Pi = 3.1415926535f;
-		constexpr real HalfPi = Pi / 2.0f;
-		constexpr real DoublePi = Pi * 2.0f;
-		constexpr real ReciprocalOf180 = 1.0f / 180.0f;
-		constexpr real ReciprocalOfPi = 0.3183098861f;
-		constexpr real GeometryEpsilon = 1e-6f;
-		constexpr real TrignometryEpsilon = 1e-3f;
-		constexpr real CCDMinVelocity = 100.0f;
-		constexpr real MaxVelocity = 1000.0f;
-		constexpr real MaxAngularVelocity = 1000.0f;
-		constexpr real AABBExpansionFactor = 0.0f;
-		constexpr real MinLinearVelocity = 1e-4f;
-		constexpr real MinAngularVelocity = 1e-4f;
-		constexpr real MinEnergy = 9e-10f;
+		constexpr real Pi = std::numbers::pi_v<real>;
+		constexpr real HalfPi = Pi / 2;
+		constexpr real DoublePi = Pi * 2;
+		constexpr real ReciprocalOf180 = real(1) / 180;
+		constexpr real ReciprocalOfPi = std::numbers::inv_pi_v<real>;
+		constexpr real GeometryEpsilon = real(1e-6);
+		constexpr real TrignometryEpsilon = real(1e-3);
+		constexpr real LinearSlop = real(0.005);
+		constexpr real CCDMinVelocity = 100;
+		constexpr real MaxVelocity = 1000;
+		constexpr real MaxAngularVelocity = 1000;
+		constexpr real AABBExpansionFactor = 0;
+		constexpr real MinLinearVelocity = real(1e-4);
+		constexpr real MinAngularVelocity = real(1e-4);
+		constexpr real MinEnergy = real(9e-10);
 		constexpr size_t SleepCountdown = 32;
 		constexpr int GJKRetryTimes = 8;
 	}
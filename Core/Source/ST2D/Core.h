@@ -23,6 +23,7 @@
 #define ST_ENABLE_CORE_LOGGER
 #define ST_ENABLE_APP_LOGGER
 #define ST_ENABLE_ASSERT
+#define ST_ENABLE_NARROWPHASE_STATS
 
 #else
 
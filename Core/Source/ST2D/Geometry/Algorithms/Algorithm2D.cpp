@@ -155,7 +155,7 @@ namespace ST
 
 		//2 * (x2 - x1) * x + 2 * (y2 - y1) y = x2 ^ 2 + y2 ^ 2 - x1 ^ 2 - y1 ^ 2;
 		//2 * (x3 - x2) * x + 2 * (y3 - y2) y = x3 ^ 2 + y3 ^ 2 - x2 ^ 2 - y2 ^ 2;
-		Matrix2x2 coef_mat{ 2.0f * (b.x - a.x), 2.0f * (c.x - b.x), 2.0f * (b.y - a.y), 2 * (c.y - b.y) };
+		Matrix2x2 coef_mat{ 2 * (b.x - a.x), 2 * (c.x - b.x), 2 * (b.y - a.y), 2 * (c.y - b.y) };
 		const Vector2 constant{ b.lengthSquare() - a.lengthSquare(), c.lengthSquare() - b.lengthSquare() };
 		return std::optional(coef_mat.invert().multiply(constant));
 	}
@@ -193,7 +193,7 @@ namespace ST
 		const real bc = (c - b).length();
 		const real ca = (a - c).length();
 		Vector2 p = (ab * c + bc * a + ca * b) / (ab + bc + ca);
-		real radius = 2.0f * area / (ab + bc + ca);
+		real radius = 2 * area / (ab + bc + ca);
 		return std::make_tuple(p, radius);
 	}
 
@@ -291,71 +291,206 @@ namespace ST
 	}
 
 
+	//bound of ellipseRoot, newton converges in a few steps and bisection fallback halves the bracket every step
+	static constexpr unsigned int EllipseRootMaxIterations = 32;
+
+	//root of F(w) = (n0 / (w + d0))^2 + (z1 / w)^2 - 1 in [lower, upper], see Eberly, Distance from a Point to an Ellipse.
+	//Eberly's parameter s is w - 1 and d0 is r0 - 1, solving for w keeps precision when the root is near s = -1.
+	//F is convex and decreasing in the bracket, newton steps leaving the shrinking bracket fall back to bisection
+	static real ellipseRoot(const real& d0, const real& n0, const real& z1, real lower, real upper, const real& epsilon)
+	{
+		real w = upper;
+		for (unsigned int i = 0; i < EllipseRootMaxIterations; ++i)
+		{
+			const real u = n0 / (w + d0);
+			const real v = z1 / w;
+			const real f = u * u + v * v - 1;
+			if (Math::abs(f) <= epsilon)
+				break;
+
+			if (f > 0)
+				lower = w;
+			else
+				upper = w;
+
+			const real df = -2 * (u * u / (w + d0) + v * v / w);
+			real next = w - f / df;
+			if (!(next > lower && next < upper))
+				next = (lower + upper) * real(0.5);
+			if (next == w)
+				break;
+			w = next;
+		}
+		return w;
+	}
+
 	Vector2 GeometryAlgorithm2D::shortestLengthPointOfEllipse(const real& a, const real& b, const Vector2& p,
 		const real& epsilon)
 	{
 		if (realEqual(a, 0) || realEqual(b, 0))
 			return {};
 
-		if (realEqual(p.x, 0))
+		//solve in the first quadrant with the major axis on x, then restore axis order and signs
+		const bool isSwap = a < b;
+		const real e0 = isSwap ? b : a;
+		const real e1 = isSwap ? a : b;
+		const real y0 = Math::abs(isSwap ? p.y : p.x);
+		const real y1 = Math::abs(isSwap ? p.x : p.y);
+		real x0, x1;
+		if (y1 > 0)
 		{
-			return p.y > 0
-				? Vector2{ 0, b }
-			: Vector2{ 0, -b };
+			if (y0 > 0)
+			{
+				const real z0 = y0 / e0;
+				const real z1 = y1 / e1;
+				const real g = z0 * z0 + z1 * z1 - 1;
+				const real r0 = (e0 / e1) * (e0 / e1);
+				const real d0 = r0 - 1;
+				const real n0 = r0 * z0;
+				const real upper = g < 0 ? 1 : std::sqrt(n0 * n0 + z1 * z1);
+				const real w = ellipseRoot(d0, n0, z1, z1, upper, epsilon);
+				x0 = r0 * y0 / (w + d0);
+				x1 = y1 / w;
+			}
+			else
+			{
+				x0 = 0;
+				x1 = e1;
+			}
 		}
-		if (realEqual(p.y, 0))
+		else
 		{
-			return p.x > 0
-				? Vector2{ a, 0 }
-			: Vector2{ -a, 0 };
+			//on the major axis, inside the evolute the closest point leaves the axis
+			const real numerator = e0 * y0;
+			const real denominator = e0 * e0 - e1 * e1;
+			const real ratio = numerator < denominator ? numerator / denominator : 1;
+			x0 = e0 * ratio;
+			x1 = e1 * std::sqrt(Math::max(1 - ratio * ratio, real(0)));
 		}
 
-		real x_left, x_right;
-		Vector2 t0, t1;
-		const int sgn = p.y > 0 ? 1 : -1;
+		Vector2 result = isSwap ? Vector2(x1, x0) : Vector2(x0, x1);
 		if (p.x < 0)
-		{
-			x_left = -a;
-			x_right = 0;
-		}
-		else
-		{
-			x_left = 0;
-			x_right = a;
-		}
-		int iteration = 0;
-		while (++iteration)
-		{
-			real temp_x = (x_left + x_right) * 0.5f;
-			real temp_y = sgn * sqrt(pow(b, 2.0f) - pow(b / a, 2.0f) * pow(temp_x, 2.0f));
-			Vector2 t0(temp_x, temp_y);
-			t0.set(temp_x, temp_y);
-			real t1_x = temp_x + 1;
-			real t1_y = (pow(b, 2.0f) - pow(b / a, 2.0f) * t1_x * temp_x) / temp_y;
-			t1.set(t1_x, t1_y);
-			Vector2 t0t1 = t1 - t0;
-			Vector2 t0p = p - t0;
-
-			const real result = t0t1.dot(t0p);
-			if (std::fabs(result) < epsilon)
-				break;
+			result.x = -result.x;
+		if (p.y < 0)
+			result.y = -result.y;
+		return result;
+	}
 
-			if (result > 0) // acute angle
-				x_left = temp_x;
-			else
-				x_right = temp_x; //obtuse angle
+	void GeometryAlgorithm2D::shortestLengthPointsOfEllipse(const real& a, const real& b,
+		std::span<const Vector2> points, std::span<Vector2> result, const real& epsilon)
+	{
+		assert(points.size() == result.size());
+		const size_t count = points.size();
+		size_t i = 0;
+
+		//same steps as shortestLengthPointOfEllipse lane by lane, converged lanes are frozen by mask.
+		//packed float kernel only, double build runs the scalar loop below for all points
+#ifndef ST_DOUBLE_PRECISION
+		static_assert(sizeof(Vector2) == 2 * sizeof(float), "points must be packed float pairs");
+		if (!realEqual(a, 0) && !realEqual(b, 0))
+		{
+			const bool isSwap = a < b;
+			const real e0 = isSwap ? b : a;
+			const real e1 = isSwap ? a : b;
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1);
+			const __m128 negativeTwo = _mm_set1_ps(-2);
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 epsilon4 = _mm_set1_ps(epsilon);
+			const __m128 e04 = _mm_set1_ps(e0);
+			const __m128 e14 = _mm_set1_ps(e1);
+			const real r0 = (e0 / e1) * (e0 / e1);
+			const __m128 r04 = _mm_set1_ps(r0);
+			const __m128 d04 = _mm_set1_ps(r0 - 1);
+			const __m128 denominator = _mm_set1_ps(e0 * e0 - e1 * e1);
+
+			const float* data = &points[0].x;
+			float* target = &result[0].x;
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 low = _mm_loadu_ps(data + 2 * i);
+				const __m128 high = _mm_loadu_ps(data + 2 * i + 4);
+				const __m128 px = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+				const __m128 py = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+				const __m128 y0 = _mm_andnot_ps(signMask, isSwap ? py : px);
+				const __m128 y1 = _mm_andnot_ps(signMask, isSwap ? px : py);
+				const __m128 isY0Positive = _mm_cmpgt_ps(y0, zero);
+				const __m128 isY1Positive = _mm_cmpgt_ps(y1, zero);
+
+				//off both axes: root of ellipseRoot
+				const __m128 z0 = _mm_div_ps(y0, e04);
+				const __m128 z1 = _mm_div_ps(y1, e14);
+				const __m128 g = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(z0, z0), _mm_mul_ps(z1, z1)), one);
+				const __m128 n0 = _mm_mul_ps(r04, z0);
+				__m128 upper = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(n0, n0), _mm_mul_ps(z1, z1)));
+				const __m128 isOutside = _mm_cmpge_ps(g, zero);
+				upper = _mm_or_ps(_mm_and_ps(isOutside, upper), _mm_andnot_ps(isOutside, one));
+				__m128 lower = z1;
+				__m128 w = upper;
+				__m128 active = _mm_and_ps(isY0Positive, isY1Positive);
+				for (unsigned int iter = 0; iter < EllipseRootMaxIterations && _mm_movemask_ps(active) != 0; ++iter)
+				{
+					const __m128 wd0 = _mm_add_ps(w, d04);
+					const __m128 u = _mm_div_ps(n0, wd0);
+					const __m128 v = _mm_div_ps(z1, w);
+					const __m128 uu = _mm_mul_ps(u, u);
+					const __m128 vv = _mm_mul_ps(v, v);
+					const __m128 f = _mm_sub_ps(_mm_add_ps(uu, vv), one);
+					active = _mm_and_ps(active, _mm_cmpgt_ps(_mm_andnot_ps(signMask, f), epsilon4));
+
+					const __m128 isPositive = _mm_cmpgt_ps(f, zero);
+					const __m128 toLower = _mm_and_ps(active, isPositive);
+					const __m128 toUpper = _mm_andnot_ps(isPositive, active);
+					lower = _mm_or_ps(_mm_and_ps(toLower, w), _mm_andnot_ps(toLower, lower));
+					upper = _mm_or_ps(_mm_and_ps(toUpper, w), _mm_andnot_ps(toUpper, upper));
+
+					const __m128 df = _mm_mul_ps(negativeTwo, _mm_add_ps(_mm_div_ps(uu, wd0), _mm_div_ps(vv, w)));
+					__m128 next = _mm_sub_ps(w, _mm_div_ps(f, df));
+					const __m128 isInside = _mm_and_ps(_mm_cmpgt_ps(next, lower), _mm_cmplt_ps(next, upper));
+					const __m128 middle = _mm_mul_ps(_mm_add_ps(lower, upper), half);
+					next = _mm_or_ps(_mm_and_ps(isInside, next), _mm_andnot_ps(isInside, middle));
+					active = _mm_and_ps(active, _mm_cmpneq_ps(next, w));
+					w = _mm_or_ps(_mm_and_ps(active, next), _mm_andnot_ps(active, w));
+				}
+				const __m128 rootX0 = _mm_div_ps(_mm_mul_ps(r04, y0), _mm_add_ps(w, d04));
+				const __m128 rootX1 = _mm_div_ps(y1, w);
+
+				//on the major axis
+				const __m128 numerator = _mm_mul_ps(e04, y0);
+				const __m128 isInEvolute = _mm_cmplt_ps(numerator, denominator);
+				const __m128 ratio = _mm_or_ps(_mm_and_ps(isInEvolute, _mm_div_ps(numerator, denominator)),
+					_mm_andnot_ps(isInEvolute, one));
+				const __m128 axisX0 = _mm_mul_ps(e04, ratio);
+				const __m128 axisX1 = _mm_mul_ps(e14, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(ratio, ratio)), zero)));
+
+				//on the minor axis the closest point is (0, e1)
+				const __m128 offX0 = _mm_and_ps(isY0Positive, rootX0);
+				const __m128 offX1 = _mm_or_ps(_mm_and_ps(isY0Positive, rootX1), _mm_andnot_ps(isY0Positive, e14));
+				const __m128 x0 = _mm_or_ps(_mm_and_ps(isY1Positive, offX0), _mm_andnot_ps(isY1Positive, axisX0));
+				const __m128 x1 = _mm_or_ps(_mm_and_ps(isY1Positive, offX1), _mm_andnot_ps(isY1Positive, axisX1));
+
+				__m128 rx = isSwap ? x1 : x0;
+				__m128 ry = isSwap ? x0 : x1;
+				rx = _mm_xor_ps(rx, _mm_and_ps(_mm_cmplt_ps(px, zero), signMask));
+				ry = _mm_xor_ps(ry, _mm_and_ps(_mm_cmplt_ps(py, zero), signMask));
+				_mm_storeu_ps(target + 2 * i, _mm_unpacklo_ps(rx, ry));
+				_mm_storeu_ps(target + 2 * i + 4, _mm_unpackhi_ps(rx, ry));
+			}
 		}
-		return t0;
+#endif
+		for (; i < count; ++i)
+			result[i] = shortestLengthPointOfEllipse(a, b, points[i], epsilon);
 	}
 
 	Vector2 GeometryAlgorithm2D::triangleCentroid(const Vector2& a1, const Vector2& a2, const Vector2& a3)
 	{
-		return Vector2(a1 + a2 + a3) / 3.0f;
+		return Vector2(a1 + a2 + a3) / 3;
 	}
 
 	real GeometryAlgorithm2D::triangleArea(const Vector2& a1, const Vector2& a2, const Vector2& a3)
 	{
-		return std::fabs(Vector2::crossProduct(a1 - a2, a1 - a3)) / 2.0f;
+		return std::fabs(Vector2::crossProduct(a1 - a2, a1 - a3)) / 2;
 	}
 
 	Vector2 GeometryAlgorithm2D::calculateCenter(const std::vector<Vector2>& vertices)
@@ -410,93 +545,40 @@ namespace ST
 	std::tuple<Vector2, Vector2> GeometryAlgorithm2D::shortestLengthLineSegmentEllipse(
 		const real& a, const real& b, const Vector2& p1, const Vector2& p2)
 	{
-		Vector2 p_line;
-		Vector2 p_ellipse;
-		if (realEqual(p1.y, p2.y))
+		const Vector2 d = p2 - p1;
+		const real lengthSquare = d.lengthSquare();
+		if (realEqual(lengthSquare, 0))
+			return std::make_tuple(shortestLengthPointOfEllipse(a, b, p1), p1);
+
+		//scale ellipse to the unit circle, point of line closest to center tells whether line and segment reach it
+		const Vector2 q1(p1.x / a, p1.y / b);
+		const Vector2 qd(d.x / a, d.y / b);
+		const real t = -q1.dot(qd) / qd.lengthSquare();
+		const real clampedT = Math::clamp(t, 0, 1);
+		const Vector2 q = q1 + qd * clampedT;
+		if (q.lengthSquare() <= 1)
 		{
-			if (!((p1.x > 0 && p2.x > 0) || (p1.x < 0 && p2.x < 0))) // different quadrant
-			{
-				p_ellipse.set(0, p1.y > 0 ? b : -b);
-				p_line.set(0, p1.y);
-			}
-			else
-			{
-				p_line.set(std::fabs(p1.x) > std::fabs(p2.x) ? p2.x : p1.x, p1.y);
-				p_ellipse = shortestLengthPointOfEllipse(a, b, p_line);
-			}
+			const Vector2 p = p1 + d * clampedT;
+			return std::make_tuple(p, p);
 		}
-		else if (realEqual(p1.x, p2.x))
+
+		if ((q1 + qd * t).lengthSquare() > 1)
 		{
-			if (!((p1.y > 0 && p2.y > 0) || (p1.y < 0 && p2.y < 0))) // different quadrant
-			{
-				p_ellipse.set(p1.x > 0 ? a : -a, 0);
-				p_line.set(p1.x, 0);
-			}
-			else
-			{
-				p_line.set(p1.x, std::fabs(p1.y) > std::fabs(p2.y) ? p2.y : p1.y);
-				p_ellipse = shortestLengthPointOfEllipse(a, b, p_line);
-			}
+			//line misses ellipse, the tangent point facing line and its projection are closest for the whole line
+			Vector2 normal = d.perpendicular();
+			if (normal.dot(p1) < 0)
+				normal.negate();
+			const Vector2 f = calculateEllipseProjectionPoint(a, b, normal);
+			const real s = (f - p1).dot(d) / lengthSquare;
+			if (s >= 0 && s <= 1)
+				return std::make_tuple(f, p1 + d * s);
+			const Vector2 end = s < 0 ? p1 : p2;
+			return std::make_tuple(shortestLengthPointOfEllipse(a, b, end), end);
 		}
-		else
-		{
-			//calculate tangent line
-			const real k = (p2.y - p1.y) / (p2.x - p1.x);
-			const real k2 = k * k;
-			const real a2 = a * a;
-			const real b2 = b * b;
-			const real f_x2 = (k2 * a2 * a2 / b2) / (1 + a2 * k2 / b2);
-			const real f_y2 = b2 - b2 * f_x2 / a2;
-			const real f_x = sqrt(f_x2);
-			const real f_y = sqrt(f_y2);
-			Vector2 f;
-			const Vector2 p1p2 = (p2 - p1).normal();
-
-			//Check which quadrant does nearest point fall in
-			{
-				Vector2 f_arr[4];
-				f_arr[0].set(f_x, f_y);
-				f_arr[1].set(-f_x, f_y);
-				f_arr[2].set(-f_x, -f_y);
-				f_arr[3].set(f_x, -f_y);
-				real min = Vector2::crossProduct(p1p2, f_arr[0] - p1);
-				for (int i = 1; i < 4; i++)
-				{
-					const real value = Vector2::crossProduct(p1p2, f_arr[i] - p1);
-					if (min > value)
-					{
-						f = f_arr[i];
-						min = value;
-					}
-				}
-			}
 
-			const Vector2 p1f = f - p1;
-			const Vector2 p1_fp = p1p2 * p1p2.dot(p1f);
-			const Vector2 f_proj = p1 + p1_fp;
-
-			if (fuzzyIsCollinear(a, b, f_proj))
-			{
-				p_ellipse = f;
-				p_line = f_proj;
-			}
-			else
-			{
-				const Vector2 p1_p = shortestLengthPointOfEllipse(a, b, p1);
-				const Vector2 p2_p = shortestLengthPointOfEllipse(a, b, p2);
-				if ((p1 - p1_p).lengthSquare() > (p2 - p2_p).lengthSquare())
-				{
-					p_ellipse = p2_p;
-					p_line = p2;
-				}
-				else
-				{
-					p_ellipse = p1_p;
-					p_line = p1;
-				}
-			}
-		}
-		return std::make_tuple(p_ellipse, p_line);
+		//line crosses ellipse out of segment, distance grows away from the chord so the nearer end is closest
+		const Vector2 end = t < 0 ? p1 : p2;
+		return std::make_tuple(shortestLengthPointOfEllipse(a, b, end), end);
 	}
 
 	std::optional<Vector2> GeometryAlgorithm2D::raycast(const Vector2& p, const Vector2& dir, const Vector2& a,
@@ -579,33 +661,15 @@ namespace ST
 
 	Vector2 GeometryAlgorithm2D::calculateEllipseProjectionPoint(const real& a, const real& b, const Vector2& direction)
 	{
-		Vector2 target;
-		if (realEqual(direction.x, 0))
-		{
-			const int sgn = direction.y < 0 ? -1 : 1;
-			target.set(0, sgn * b);
-		}
-		else if (realEqual(direction.y, 0))
-		{
-			const int sgn = direction.x < 0 ? -1 : 1;
-			target.set(sgn * a, 0);
-		}
-		else
-		{
-			const real k = direction.y / direction.x;
-			//line offset constant d
-			const real a2 = pow(a, 2.0f);
-			const real b2 = pow(b, 2.0f);
-			const real k2 = pow(k, 2.0f);
-			real d = sqrt((a2 + b2 * k2) / k2);
-			if (Vector2::dotProduct(Vector2(0, d), direction) < 0)
-				d = d * -1;
-			const real x1 = k * d - (b2 * k2 * k * d) / (a2 + b2 * k2);
-			const real y1 = (b2 * k2 * d) / (a2 + b2 * k2);
-			target.set(x1, y1);
-		}
-		return target;
+		//maximize dot(direction, (a * cos, b * sin)), so (cos, sin) is parallel to (a * dx, b * dy)
+		const real ax = a * direction.x;
+		const real by = b * direction.y;
+		const real length = std::sqrt(ax * ax + by * by);
+		if (realEqual(length, 0))
+			return { 0, b };
+		return { a * ax / length, b * by / length };
 	}
+
 	Vector2 GeometryAlgorithm2D::calculateCapsuleProjectionPoint(const real& halfWidth, const real& halfHeight, const Vector2& direction)
 	{
 		Vector2 target;
@@ -112,13 +112,24 @@ namespace ST
 		static std::vector<Vector2> grahamScan(const std::vector<Vector2>& vertices);
 		/**
 		 * \brief Calculate point on ellipse that is the shortest length to point p(aka projection point).
+		 * Root of Eberly's distance function is found by newton steps guarded by bisection, so iterations are bounded.
 		 * \param a
 		 * \param b
 		 * \param p
-		 * \param epsilon
+		 * \param epsilon tolerance of the normalized ellipse equation at result
 		 * \return
 		 */
 		static Vector2 shortestLengthPointOfEllipse(const real& a, const real& b, const Vector2& p, const real& epsilon = Constant::GeometryEpsilon);
+		/**
+		 * \brief Batched shortestLengthPointOfEllipse, four points per SSE register. Result is the same as calling it per point.
+		 * \param a
+		 * \param b
+		 * \param points
+		 * \param result must have the same size as points
+		 * \param epsilon
+		 */
+		static void shortestLengthPointsOfEllipse(const real& a, const real& b, std::span<const Vector2> points,
+			std::span<Vector2> result, const real& epsilon = Constant::GeometryEpsilon);
 		/**
 		 * \brief Calculate the centroid of triangle.
 		 * \param a1
@@ -143,7 +154,8 @@ namespace ST
 		static Vector2 calculateCenter(const std::vector<Vector2>& vertices);
 		static Vector2 calculateCenter(const std::list<Vector2>& vertices);
 		/**
-		 * \brief Calculate two points on line segment and ellipse respectively. The length of two points is the shortest distance of line segment and ellipse
+		 * \brief Calculate two points on line segment and ellipse respectively. The length of two points is the shortest distance of line segment and ellipse.
+		 * If segment overlaps ellipse, both points are the point of segment deepest inside ellipse.
 		 * \param a major axis a
 		 * \param b minor axis b
 		 * \param p1 line segment point 1
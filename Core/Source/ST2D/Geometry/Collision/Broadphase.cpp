@@ -0,0 +1,28 @@
+#include "Broadphase.h"
+
+#include "Tree.h"
+#include "UniformGrid.h"
+#include "SweepAndPrune.h"
+
+namespace ST
+{
+	void Broadphase::moveProxies(const std::vector<ShapePrimitive*>& bodies)
+	{
+		for (auto&& body : bodies)
+			moveProxy(body);
+	}
+
+	std::unique_ptr<Broadphase> Broadphase::create(BroadphaseType type)
+	{
+		switch (type)
+		{
+		case BroadphaseType::Tree:
+			return std::make_unique<Tree>();
+		case BroadphaseType::UniformGrid:
+			return std::make_unique<UniformGrid>();
+		case BroadphaseType::SweepAndPrune:
+			return std::make_unique<SweepAndPrune>();
+		}
+		return nullptr;
+	}
+}
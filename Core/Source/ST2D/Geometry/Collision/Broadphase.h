@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ST2D/Geometry/Shape/AABB.h"
+
+namespace ST
+{
+	enum class BroadphaseType
+	{
+		Tree,
+		UniformGrid,
+		SweepAndPrune
+	};
+
+	/// <summary>
+	/// Common interface of broadphase backends.
+	///	A proxy is identified by the body pointer it was created with.
+	/// </summary>
+	class ST_API Broadphase
+	{
+	public:
+		virtual ~Broadphase() = default;
+
+		virtual BroadphaseType type() const = 0;
+
+		virtual void createProxy(ShapePrimitive* body) = 0;
+		/// <summary>
+		/// Notify the backend that transform or shape of body has been changed.
+		/// </summary>
+		/// <param name="body"></param>
+		virtual void moveProxy(ShapePrimitive* body) = 0;
+		/// <summary>
+		/// Batch version of moveProxy. Backends override this to compute AABB of all bodies at once.
+		/// </summary>
+		/// <param name="bodies"></param>
+		virtual void moveProxies(const std::vector<ShapePrimitive*>& bodies);
+		virtual void destroyProxy(ShapePrimitive* body) = 0;
+		virtual void clearAll() = 0;
+
+		/// <summary>
+		/// Return all pairs of proxies whose AABB are overlapping.
+		/// </summary>
+		/// <returns></returns>
+		virtual std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> updatePairs() = 0;
+		virtual std::vector<ShapePrimitive*> query(const AABB& region) = 0;
+		virtual std::vector<ShapePrimitive*> raycast(const Vector2& start, const Vector2& direction) = 0;
+
+		/// <summary>
+		/// Create backend by type, so that it can be switched at runtime.
+		/// </summary>
+		/// <param name="type"></param>
+		/// <returns></returns>
+		static std::unique_ptr<Broadphase> create(BroadphaseType type);
+	};
+}
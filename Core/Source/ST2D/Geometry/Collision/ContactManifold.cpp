@@ -0,0 +1,114 @@
+#include "ContactManifold.h"
+
+namespace ST
+{
+	ContactManifold& ManifoldCache::update(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		//same order as mixPairUUID, so that a pair passed in swapped order finds the same points
+		const bool isSwap = shapeA.userData.uuid > shapeB.userData.uuid;
+		const ShapePrimitive& realShapeA = isSwap ? shapeB : shapeA;
+		const ShapePrimitive& realShapeB = isSwap ? shapeA : shapeB;
+
+		auto [manifold, isNew] = m_manifolds.emplace(mixPairUUID(shapeA.userData.uuid, shapeB.userData.uuid));
+		if (!isNew && refresh(*manifold, realShapeA, realShapeB))
+			return *manifold;
+
+		CollisionInfo info;
+		ContactPair contacts;
+		if (!Narrowphase::collide(realShapeA, realShapeB, info, contacts, &manifold->simplex, speculativeMargin))
+			contacts.count = 0;
+
+		merge(*manifold, realShapeA, realShapeB, info, contacts);
+		return *manifold;
+	}
+
+	void ManifoldCache::merge(ContactManifold& manifold, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		const CollisionInfo& info, const ContactPair& contacts)
+	{
+		const std::array<ManifoldPoint, 2> oldPoints = manifold.points;
+		const uint32_t oldCount = manifold.count;
+
+		manifold.count = contacts.count / 2;
+		manifold.normal = info.normal;
+		manifold.localNormal = shapeA.transform.inverseRotatePoint(info.normal);
+		manifold.transformA = shapeA.transform;
+		manifold.transformB = shapeB.transform;
+
+		for (uint32_t i = 0; i < manifold.count; ++i)
+		{
+			ManifoldPoint& point = manifold.points[i];
+			point = ManifoldPoint();
+			point.id = contacts.pointIds[i];
+			point.pointA = contacts.points[i * 2];
+			point.pointB = contacts.points[i * 2 + 1];
+			point.localPointA = shapeA.transform.inverseTranslatePoint(point.pointA);
+			point.localPointB = shapeB.transform.inverseTranslatePoint(point.pointB);
+			//pointB - pointA = normal * penetration
+			point.separation = (point.pointA - point.pointB).dot(info.normal);
+
+			for (uint32_t j = 0; j < oldCount; ++j)
+			{
+				if (oldPoints[j].id != point.id)
+					continue;
+				point.normalImpulse = oldPoints[j].normalImpulse;
+				point.tangentImpulse = oldPoints[j].tangentImpulse;
+				point.isPersisted = true;
+				break;
+			}
+		}
+	}
+
+	bool ManifoldCache::refresh(ContactManifold& manifold, const ShapePrimitive& shapeA,
+		const ShapePrimitive& shapeB) const
+	{
+		//separated pairs may come into contact by any small motion
+		if (manifold.count == 0)
+			return false;
+
+		if (shapeA.transform.scale != manifold.transformA.scale || shapeB.transform.scale != manifold.transformB.scale)
+			return false;
+
+		//motion of B in local space of A
+		const Vector2 relativePosition = shapeA.transform.inverseRotatePoint(
+			shapeB.transform.position - shapeA.transform.position);
+		const Vector2 oldRelativePosition = manifold.transformA.inverseRotatePoint(
+			manifold.transformB.position - manifold.transformA.position);
+		const real relativeRotation = shapeB.transform.rotation - shapeA.transform.rotation;
+		const real oldRelativeRotation = manifold.transformB.rotation - manifold.transformA.rotation;
+
+		if ((relativePosition - oldRelativePosition).lengthSquare() > linearThreshold * linearThreshold
+			|| Math::abs(relativeRotation - oldRelativeRotation) > angularThreshold)
+			return false;
+
+		manifold.normal = Matrix2x2(shapeA.transform.rotation).multiply(manifold.localNormal);
+		for (uint32_t i = 0; i < manifold.count; ++i)
+		{
+			ManifoldPoint& point = manifold.points[i];
+			point.pointA = shapeA.transform.translatePoint(point.localPointA);
+			point.pointB = shapeB.transform.translatePoint(point.localPointB);
+			point.separation = (point.pointA - point.pointB).dot(manifold.normal);
+			point.isPersisted = true;
+		}
+		return true;
+	}
+
+	ContactManifold* ManifoldCache::find(const PairID& id)
+	{
+		return m_manifolds.find(id);
+	}
+
+	bool ManifoldCache::erase(const PairID& id)
+	{
+		return m_manifolds.erase(id);
+	}
+
+	size_t ManifoldCache::size() const
+	{
+		return m_manifolds.size();
+	}
+
+	void ManifoldCache::clearAll()
+	{
+		m_manifolds.clear();
+	}
+}
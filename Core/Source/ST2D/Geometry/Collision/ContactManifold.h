@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Narrowphase.h"
+
+namespace ST
+{
+	struct ST_API ManifoldPoint
+	{
+		//key of touching features from ContactPair::pointIds
+		uint64_t id = 0;
+		//world points, same convention as ContactPair
+		Vector2 pointA;
+		Vector2 pointB;
+		//points in local space of shape A and shape B, used to refresh world points without collide
+		Vector2 localPointA;
+		Vector2 localPointB;
+		//along normal, negative when overlapping
+		real separation = 0;
+		//accumulated by solver, carried to the next frame if id matches
+		real normalImpulse = 0;
+		real tangentImpulse = 0;
+		//whether impulses are carried from the last frame
+		bool isPersisted = false;
+	};
+
+	/**
+	 * \brief Contacts of one pair that live across frames. Shape with smaller uuid is always A.
+	 */
+	struct ST_API ContactManifold
+	{
+		std::array<ManifoldPoint, 2> points;
+		uint32_t count = 0;
+		//from B to A, same as CollisionInfo
+		Vector2 normal;
+		Vector2 localNormal;
+		//transforms when contacts were generated by collide
+		Transform transformA;
+		Transform transformB;
+		//gjk warm start of the generic path
+		SimplexCache simplex;
+	};
+
+	/**
+	 * \brief Manifold per PairID. New contacts are matched to old ones by feature id, so accumulated impulses
+	 * survive to warm start the solver. Pairs that barely moved relative to each other skip collide entirely.\n
+	 * Entries are never removed by update, erase them when the pair ends, e.g. on PairManager::endPairs.
+	 */
+	class ST_API ManifoldCache
+	{
+	public:
+		/**
+		 * \brief Refresh the manifold of pair. If relative motion since contacts were generated is below
+		 * thresholds, world points are rebuilt from local points, otherwise Narrowphase::collide runs
+		 * and its result is merged.
+		 * \param shapeA
+		 * \param shapeB
+		 * \return manifold of pair, count is 0 if shapes are separated farther than speculativeMargin
+		 */
+		ContactManifold& update(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+
+		/**
+		 * \brief Replace contacts of manifold by collide output, impulses of points with the same id are kept.
+		 * Shapes must be in the order of manifold.
+		 */
+		static void merge(ContactManifold& manifold, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			const CollisionInfo& info, const ContactPair& contacts);
+
+		ContactManifold* find(const PairID& id);
+		bool erase(const PairID& id);
+		size_t size() const;
+		void clearAll();
+
+		//relative motion below which collide is skipped, 0 disables skipping
+		real linearThreshold = real(0.001);
+		real angularThreshold = real(0.001);
+		//pairs closer than margin keep speculative points with positive separation, 0 keeps touching pairs only
+		real speculativeMargin = 0;
+
+	private:
+		bool refresh(ContactManifold& manifold, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB) const;
+
+		PairTable<ContactManifold> m_manifolds;
+	};
+}
@@ -1,17 +1,193 @@
 #include "Narrowphase.h"
+#include "NarrowphaseStats.h"
 
 #include "ST2D/Geometry/Shape/Capsule.h"
 #include "ST2D/Geometry/Shape/Ellipse.h"
 #include "ST2D/Geometry/Shape/Polygon.h"
 #include "ST2D/Geometry/Shape/Circle.h"
 #include "ST2D/Geometry/Shape/Edge.h"
+#include "ST2D/Geometry/Shape/ShapeCache.h"
+#include "ST2D/Utility/ThreadPool.h"
 
 namespace ST
 {
+	//results are copied around per pair, debug data lives in CollisionDebugInfo
+	static_assert(std::is_trivially_copyable_v<CollisionInfo>);
+
+	//minimum count of pairs computed by one worker thread in Narrowphase::collideBatch
+	static constexpr size_t NarrowphaseBatchGrainSize = 32;
+
+	//shapeA and shapeB of the enclosing function are recorded
+#define RECORD_QUERY(query, iterations, exit) ST_NARROWPHASE_STATS(NarrowphaseProfiler::record( \
+	NarrowphaseQuery::query, shapeA, shapeB, iterations, QueryExit::exit))
+
+	//radius of the circle around local origin that encloses the shape, bounds the speed of points by rotation
+	static real boundingRadius(const Shape* shape)
+	{
+		switch (shape->type())
+		{
+		case ShapeType::Polygon:
+		{
+			real radius = 0;
+			for (const Vector2& vertex : static_cast<const Polygon*>(shape)->vertices())
+				radius = Math::max(radius, vertex.length());
+			return radius;
+		}
+		case ShapeType::Edge:
+		{
+			const Edge* edge = static_cast<const Edge*>(shape);
+			return Math::max(edge->startPoint().length(), edge->endPoint().length());
+		}
+		case ShapeType::Capsule:
+		{
+			const Capsule* capsule = static_cast<const Capsule*>(shape);
+			return Math::max(capsule->halfWidth(), capsule->halfHeight());
+		}
+		case ShapeType::Circle:
+			return static_cast<const Circle*>(shape)->radius();
+		case ShapeType::Ellipse:
+			return static_cast<const Ellipse*>(shape)->A();
+		}
+		return 0;
+	}
+
+	//reduce simplex to the smallest sub simplex that contains the point closest to origin, returns the point.
+	//weights are barycentric coordinates of the point over the remaining vertices.
+	//count stays 3 only if origin is inside the triangle.
+	static Vector2 closestPointToOrigin(Simplex& simplex, std::array<real, 3>& weights)
+	{
+		std::array<SimplexVertex, 3>& vertices = simplex.vertices;
+		const auto keepEdge = [&](const Index& i, const Index& j, const real& wi, const real& wj)
+			{
+				const SimplexVertex vi = vertices[i];
+				const SimplexVertex vj = vertices[j];
+				vertices[0] = vi;
+				vertices[1] = vj;
+				weights = { wi / (wi + wj), wj / (wi + wj), 0 };
+				simplex.count = 2;
+			};
+		const auto keepVertex = [&](const Index& i)
+			{
+				vertices[0] = vertices[i];
+				weights = { 1, 0, 0 };
+				simplex.count = 1;
+			};
+
+		if (simplex.count == 1)
+		{
+			weights = { 1, 0, 0 };
+			return vertices[0].result;
+		}
+
+		const Vector2 w1 = vertices[0].result;
+		const Vector2 w2 = vertices[1].result;
+
+		const Vector2 e12 = w2 - w1;
+		const real d12_1 = w2.dot(e12);
+		const real d12_2 = -w1.dot(e12);
+
+		if (simplex.count == 2)
+		{
+			if (d12_2 <= 0)
+				keepVertex(0);
+			else if (d12_1 <= 0)
+				keepVertex(1);
+			else
+				keepEdge(0, 1, d12_1, d12_2);
+		}
+		else
+		{
+			const Vector2 w3 = vertices[2].result;
+
+			const Vector2 e13 = w3 - w1;
+			const real d13_1 = w3.dot(e13);
+			const real d13_2 = -w1.dot(e13);
+
+			const Vector2 e23 = w3 - w2;
+			const real d23_1 = w3.dot(e23);
+			const real d23_2 = -w2.dot(e23);
+
+			const real n123 = Vector2::crossProduct(e12, e13);
+			const real d123_1 = n123 * Vector2::crossProduct(w2, w3);
+			const real d123_2 = n123 * Vector2::crossProduct(w3, w1);
+			const real d123_3 = n123 * Vector2::crossProduct(w1, w2);
+
+			if (d12_2 <= 0 && d13_2 <= 0)
+				keepVertex(0);
+			else if (d12_1 > 0 && d12_2 > 0 && d123_3 <= 0)
+				keepEdge(0, 1, d12_1, d12_2);
+			else if (d13_1 > 0 && d13_2 > 0 && d123_2 <= 0)
+				keepEdge(0, 2, d13_1, d13_2);
+			else if (d12_1 <= 0 && d23_2 <= 0)
+				keepVertex(1);
+			else if (d13_1 <= 0 && d23_1 <= 0)
+				keepVertex(2);
+			else if (d23_1 > 0 && d23_2 > 0 && d123_1 <= 0)
+				keepEdge(1, 2, d23_1, d23_2);
+			else
+			{
+				const real sum = d123_1 + d123_2 + d123_3;
+				weights = { d123_1 / sum, d123_2 / sum, d123_3 / sum };
+				return { 0, 0 };
+			}
+		}
+
+		Vector2 point;
+		for (Index i = 0; i < simplex.count; ++i)
+			point += vertices[i].result * weights[i];
+		return point;
+	}
+
+	//support point of A - B without feature bookkeeping
+	static Vector2 supportPoint(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const Vector2& direction)
+	{
+		return Narrowphase::findFurthestPoint(shapeA, direction).first
+			- Narrowphase::findFurthestPoint(shapeB, direction.negative()).first;
+	}
+
 	Simplex Narrowphase::gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const size_t& iteration)
 	{
 		Simplex simplex;
+		initializeSimplex(simplex, shapeA, shapeB);
+		return gjkIterate(simplex, shapeA, shapeB, iteration);
+	}
 
+	Simplex Narrowphase::gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, SimplexCache& cache,
+		const size_t& iteration)
+	{
+		Simplex simplex;
+		if (!restoreSimplex(cache, shapeA, shapeB, simplex))
+			initializeSimplex(simplex, shapeA, shapeB);
+		else if (simplex.count == 3)
+		{
+			//last triangle may still contain origin
+			reconstructSimplexByVoronoi(simplex);
+			if (!simplex.isContainOrigin)
+			{
+				//its edges need not face origin anymore, start over
+				simplex.removeAll();
+				initializeSimplex(simplex, shapeA, shapeB);
+			}
+		}
+
+		if (!simplex.isContainOrigin)
+			simplex = gjkIterate(simplex, shapeA, shapeB, iteration);
+		else
+			RECORD_QUERY(Gjk, 0, Converged);
+
+		storeSimplex(simplex, shapeA, shapeB, cache);
+		return simplex;
+	}
+
+	Simplex Narrowphase::gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		PairTable<SimplexCache>& caches, const size_t& iteration)
+	{
+		SimplexCache* cache = caches.emplace(mixPairUUID(shapeA.userData.uuid, shapeB.userData.uuid)).first;
+		return gjk(shapeA, shapeB, *cache, iteration);
+	}
+
+	void Narrowphase::initializeSimplex(Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
 		Vector2 direction = shapeB.transform.position - shapeA.transform.position;
 
 		if (direction.fuzzyEqual({ 0, 0 }))
@@ -30,67 +206,239 @@ namespace ST
 		//try to reconfigure simplex to avoid 1d simplex cross origin
 		if (simplex.containsOrigin())
 		{
+			ST_NARROWPHASE_STATS(NarrowphaseProfiler::recordPerturbation(shapeA, shapeB));
 			const bool result = perturbSimplex(simplex, shapeA, shapeB, direction);
 			if (!result)
 				assert(false && "Cannot reconstruct simplex.");
 		}
+	}
 
+	Simplex Narrowphase::gjkIterate(Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		const size_t& iteration)
+	{
+		Vector2 direction;
+		SimplexVertex vertex;
 		//third
 		for (Index iter = 0; iter <= iteration; ++iter)
 		{
 			//default closest edge is index 0 and index 1
 			direction = findDirectionByEdge(simplex.vertices[0], simplex.vertices[1], true);
-			vertex = support(shapeA, shapeB, direction);
+			vertex = support(shapeA, shapeB, direction, simplex.vertices[0].index[0],
+				simplex.vertices[0].index[1]);
 
 			//find repeated vertex
 			if (simplex.contains(vertex))
-				break;
+			{
+				RECORD_QUERY(Gjk, iter + 1, EarlyExit);
+				return simplex;
+			}
 
 			//vertex does not pass origin
 			if (vertex.result.dot(direction) <= 0)
-				break;
+			{
+				RECORD_QUERY(Gjk, iter + 1, EarlyExit);
+				return simplex;
+			}
 
 			simplex.addSimplexVertex(vertex);
 
 			reconstructSimplexByVoronoi(simplex);
 			if (simplex.isContainOrigin)
+			{
+				RECORD_QUERY(Gjk, iter + 1, Converged);
 				return simplex;
+			}
 
 			simplex.removeEnd();
 		}
+		RECORD_QUERY(Gjk, iteration + 1, IterationLimit);
 		return simplex;
 	}
 
+	bool Narrowphase::restoreSimplex(const SimplexCache& cache, const ShapePrimitive& shapeA,
+		const ShapePrimitive& shapeB, Simplex& simplex)
+	{
+		if (cache.count < 2)
+			return false;
+
+		//cached side 0 belongs to the shape that was A when stored
+		const bool isSwap = cache.uuidA != shapeA.userData.uuid;
+		const ShapePrimitive* shapes[2] = { isSwap ? &shapeB : &shapeA, isSwap ? &shapeA : &shapeB };
+
+		for (size_t i = 0; i < cache.count; ++i)
+		{
+			const SimplexCache::Vertex& cached = cache.vertices[i];
+			Vector2 points[2];
+			for (Index side = 0; side < 2; ++side)
+			{
+				const ShapePrimitive& shape = *shapes[side];
+				const Index index = cached.index[side];
+				if (shape.shape->type() == ShapeType::Polygon && index != UINT32_MAX)
+				{
+					if (index >= static_cast<const Polygon*>(shape.shape)->vertices().size())
+						return false;
+					points[side] = polygonVertex(shape, index);
+				}
+				else
+					points[side] = shape.transform.translatePoint(cached.localPoint[side]);
+			}
+			if (isSwap)
+				simplex.addSimplexVertex(SimplexVertex(points[1], points[0], cached.index[1], cached.index[0]));
+			else
+				simplex.addSimplexVertex(SimplexVertex(points[0], points[1], cached.index[0], cached.index[1]));
+		}
+
+		//drop degenerate triangle, reconstructSimplexByVoronoi needs non-zero area
+		if (simplex.count == 3)
+		{
+			const Vector2 ab = simplex.vertices[1].result - simplex.vertices[0].result;
+			const Vector2 ac = simplex.vertices[2].result - simplex.vertices[0].result;
+			if (Math::abs(ab.cross(ac)) <= Constant::GeometryEpsilon)
+				simplex.removeEnd();
+		}
+
+		simplex.isContainOrigin = false;
+		//triangle is left to reconstructSimplexByVoronoi in gjk, it contains origin for resting pairs.
+		//Segment must be valid and must not cross origin, same requirement as initializeSimplex
+		if (simplex.count == 2)
+		{
+			const Vector2 edge = simplex.vertices[1].result - simplex.vertices[0].result;
+			if (edge.lengthSquare() <= Constant::GeometryEpsilon || Simplex::containOrigin(simplex))
+			{
+				simplex.removeAll();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Narrowphase::storeSimplex(const Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		SimplexCache& cache)
+	{
+		cache.count = simplex.count;
+		cache.uuidA = shapeA.userData.uuid;
+		for (size_t i = 0; i < simplex.count; ++i)
+		{
+			const SimplexVertex& vertex = simplex.vertices[i];
+			SimplexCache::Vertex& cached = cache.vertices[i];
+			cached.index[0] = vertex.index[0];
+			cached.index[1] = vertex.index[1];
+			cached.localPoint[0] = shapeA.transform.inverseTranslatePoint(vertex.point[0]);
+			cached.localPoint[1] = shapeB.transform.inverseTranslatePoint(vertex.point[1]);
+		}
+	}
+
+	bool Narrowphase::overlapGeneric(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		const size_t& iteration)
+	{
+		Vector2 direction = shapeB.transform.position - shapeA.transform.position;
+		if (direction.fuzzyEqual({ 0, 0 }))
+			direction.set(1, 1);
+
+		//newest point is always the last one
+		std::array<Vector2, 3> points;
+		points[0] = supportPoint(shapeA, shapeB, direction);
+		if (points[0].dot(direction) < 0)
+			return false;
+
+		size_t count = 1;
+		direction = points[0].negative();
+
+		for (Index iter = 0; iter < iteration; ++iter)
+		{
+			//origin is on the simplex
+			if (direction.fuzzyEqual({ 0, 0 }))
+				return true;
+
+			const Vector2 point = supportPoint(shapeA, shapeB, direction);
+			//separating axis found
+			if (point.dot(direction) < 0)
+				return false;
+
+			points[count++] = point;
+			const Vector2 ao = point.negative();
+
+			if (count == 2)
+			{
+				const Vector2 ab = points[0] - point;
+				if (ab.dot(ao) > 0)
+				{
+					direction = ab.perpendicular();
+					if (direction.dot(ao) < 0)
+						direction.negate();
+					//origin is on segment
+					if (realEqual(direction.dot(ao), 0))
+						return true;
+				}
+				else
+				{
+					points[0] = point;
+					count = 1;
+					direction = ao;
+				}
+				continue;
+			}
+
+			//triangle, origin can only be outside of edges ab or ac
+			const Vector2 ab = points[1] - point;
+			const Vector2 ac = points[0] - point;
+			Vector2 abNormal = ab.perpendicular();
+			if (abNormal.dot(ac) > 0)
+				abNormal.negate();
+			Vector2 acNormal = ac.perpendicular();
+			if (acNormal.dot(ab) > 0)
+				acNormal.negate();
+
+			if (abNormal.dot(ao) > 0)
+			{
+				points[0] = points[1];
+				points[1] = point;
+				count = 2;
+				direction = abNormal;
+			}
+			else if (acNormal.dot(ao) > 0)
+			{
+				points[1] = point;
+				count = 2;
+				direction = acNormal;
+			}
+			else
+				return true;
+		}
+		return false;
+	}
+
 	CollisionInfo Narrowphase::epa(const Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const size_t& iteration, const real& epsilon)
+		const size_t& iteration, const real& epsilon, CollisionDebugInfo* debug)
 	{
 		//return 1d simplex with edge closest to origin
 		CollisionInfo info;
 		info.simplex = simplex;
 		info.simplex.removeEnd();
 
-		//initiate polytope
-
-		//[Debug]
-		std::list<SimplexVertexWithOriginDistance>& polytope = info.polytope;
-		//std::list<SimplexVertexWithOriginDistance> polytope;
+		if (debug != nullptr)
+			debug->originalSimplex = simplex;
 
-		buildPolytopeFromSimplex(polytope, simplex);
+		//initiate polytope, gjk has set closest edge to index 0 and 1
+		Polytope polytope;
+		polytope.build(simplex);
+		Index edge = 0;
 
-		auto iterStart = polytope.begin();
-		auto iterEnd = polytope.end();
-		auto iterTemp = polytope.begin();
-
-		for (Index iter = 0; iter < iteration; ++iter)
+		Index iter = 0;
+		for (; iter < iteration; ++iter)
 		{
 			//indices of closest edge are set to 0 and 1
 			const Vector2 direction = findDirectionByEdge(info.simplex.vertices[0], info.simplex.vertices[1], false);
 
-			const SimplexVertex vertex = support(shapeA, shapeB, direction);
+			const SimplexVertex vertex = support(shapeA, shapeB, direction, info.simplex.vertices[0].index[0],
+				info.simplex.vertices[0].index[1]);
 
 			//cannot find any new vertex
 			if (info.simplex.contains(vertex))
+			{
+				RECORD_QUERY(Epa, iter + 1, Converged);
 				break;
+			}
 
 			//check if new vertex is located in support direction
 
@@ -102,57 +450,30 @@ namespace ST
 			Vector2 ac = vertex.result - info.simplex.vertices[0].result;
 			Vector2 bc = vertex.result - info.simplex.vertices[1].result;
 
-			bool validVoronoi = ab.dot(ac) > 0.0f && -ab.dot(bc) > 0.0f;
+			bool validVoronoi = ab.dot(ac) > 0 && -ab.dot(bc) > 0;
 
 			if (!validSide || !validVoronoi)
+			{
+				RECORD_QUERY(Epa, iter + 1, Converged);
 				break;
+			}
 
-			auto itA = iterStart;
-
-			auto itB = itA;
-			polytopeIterNext(itB, polytope);
-
-			SimplexVertexWithOriginDistance pair;
-			pair.vertex = vertex;
-			const Vector2 t1 = GeometryAlgorithm2D::pointToLineSegment(itA->vertex.result, vertex.result, { 0, 0 });
-			const real dist1 = t1.lengthSquare();
-			const Vector2 t2 = GeometryAlgorithm2D::pointToLineSegment(vertex.result, itB->vertex.result, { 0, 0 });
-			const real dist2 = t2.lengthSquare();
-
-			itA->distance = dist1;
-			pair.distance = dist2;
-			polytope.insert(itB, pair);
-
-			//set to begin
-			iterTemp = iterStart;
-
-			//find shortest distance and set iterStart
-			real minDistance = Constant::Max;
-			auto iterTarget = iterStart;
-			while (true)
+			if (polytope.insert(edge, vertex) == UINT32_MAX)
 			{
-				if (iterTemp->distance < minDistance)
-				{
-					minDistance = iterTemp->distance;
-					iterTarget = iterTemp;
-				}
-				polytopeIterNext(iterTemp, polytope);
-				if (iterTemp == iterStart)
-					break;
+				RECORD_QUERY(Epa, iter + 1, Degenerate);
+				break;
 			}
-			iterStart = iterTarget;
-			iterEnd = iterTarget;
-			polytopeIterPrev(iterEnd, polytope);
-
-			//set to begin
-			iterTemp = iterStart;
-			polytopeIterNext(iterTemp, polytope);
-			//reset simplex
-			info.simplex.vertices[0] = iterStart->vertex;
-			info.simplex.vertices[1] = iterTemp->vertex;
-
 
+			//reset simplex to closest edge
+			edge = polytope.closestEdge(edge);
+			info.simplex.vertices[0] = polytope.vertex(edge);
+			info.simplex.vertices[1] = polytope.vertex(polytope.next(edge));
 		}
+		if (iter == iteration)
+			RECORD_QUERY(Epa, iter, IterationLimit);
+
+		if (debug != nullptr)
+			polytope.exportTo(debug->polytope);
 
 		const Vector2 temp = -GeometryAlgorithm2D::pointToLineSegment(info.simplex.vertices[0].result,
 			info.simplex.vertices[1].result
@@ -169,16 +490,17 @@ namespace ST
 	}
 
 	SimplexVertex Narrowphase::support(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Vector2& direction)
+		const Vector2& direction, const Index& hintA, const Index& hintB)
 	{
 		SimplexVertex vertex;
-		std::tie(vertex.point[0], vertex.index[0]) = findFurthestPoint(shapeA, direction);
-		std::tie(vertex.point[1], vertex.index[1]) = findFurthestPoint(shapeB, direction.negative());
+		std::tie(vertex.point[0], vertex.index[0]) = findFurthestPoint(shapeA, direction, hintA);
+		std::tie(vertex.point[1], vertex.index[1]) = findFurthestPoint(shapeB, direction.negative(), hintB);
 		vertex.result = vertex.point[0] - vertex.point[1];
 		return vertex;
 	}
 
-	std::pair<Vector2, Index> Narrowphase::findFurthestPoint(const ShapePrimitive& shape, const Vector2& direction)
+	std::pair<Vector2, Index> Narrowphase::findFurthestPoint(const ShapePrimitive& shape, const Vector2& direction,
+		const Index& hint)
 	{
 		Vector2 target;
 		Matrix2x2 rot(-shape.transform.rotation);
@@ -188,8 +510,12 @@ namespace ST
 		{
 		case ShapeType::Polygon:
 		{
+			//world vertices are ready, no need to rotate direction and result
+			if (const ShapeCache* cache = shape.validCache())
+				return findFurthestPoint(cache->vertices, direction, hint);
+
 			auto polygon = static_cast<const Polygon*>(shape.shape);
-			std::tie(target, finalIndex) = findFurthestPoint(polygon->vertices(), rot_dir);
+			std::tie(target, finalIndex) = findFurthestPoint(polygon->vertices(), rot_dir, hint);
 			break;
 		}
 		case ShapeType::Circle:
@@ -247,41 +573,113 @@ namespace ST
 	std::pair<Vector2, Index> Narrowphase::findFurthestPoint(const std::vector<Vector2>& vertices,
 		const Vector2& direction)
 	{
+		assert(!vertices.empty());
+		const size_t count = vertices.size();
 		real max = Constant::NegativeMin;
-		Vector2 target;
 		Index index = 0;
-		for (Index i = 0; i < vertices.size(); i++)
+		size_t i = 0;
+
+		//packed float kernel only, double build runs the scalar loop below for all vertices
+#ifndef ST_DOUBLE_PRECISION
+		static_assert(sizeof(Vector2) == 2 * sizeof(float), "vertices must be packed float pairs");
+		const float* data = &vertices[0].x;
+		const __m128 directionX = _mm_set1_ps(direction.x);
+		const __m128 directionY = _mm_set1_ps(direction.y);
+		__m128 max4 = _mm_set1_ps(Constant::NegativeMin);
+		__m128i index4 = _mm_setzero_si128();
+		__m128i current4 = _mm_setr_epi32(0, 1, 2, 3);
+		const __m128i step4 = _mm_set1_epi32(4);
+
+		//deinterleave four vertices into {x0, x1, x2, x3} and {y0, y1, y2, y3}, keep lane-wise first maximum
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 low = _mm_loadu_ps(data + 2 * i);
+			const __m128 high = _mm_loadu_ps(data + 2 * i + 4);
+			const __m128 x = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			const __m128 y = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+			const __m128 dot = _mm_add_ps(_mm_mul_ps(x, directionX), _mm_mul_ps(y, directionY));
+			const __m128 greater = _mm_cmpgt_ps(dot, max4);
+			const __m128i greaterMask = _mm_castps_si128(greater);
+			max4 = _mm_or_ps(_mm_and_ps(greater, dot), _mm_andnot_ps(greater, max4));
+			index4 = _mm_or_si128(_mm_and_si128(greaterMask, current4), _mm_andnot_si128(greaterMask, index4));
+			current4 = _mm_add_epi32(current4, step4);
+		}
+
+		alignas(16) float maxLanes[4];
+		alignas(16) int32_t indexLanes[4];
+		_mm_store_ps(maxLanes, max4);
+		_mm_store_si128(reinterpret_cast<__m128i*>(indexLanes), index4);
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			const Index laneIndex = static_cast<Index>(indexLanes[lane]);
+			if (max < maxLanes[lane] || (max == maxLanes[lane] && laneIndex < index))
+			{
+				max = maxLanes[lane];
+				index = laneIndex;
+			}
+		}
+#endif
+		//remaining vertices have larger indices than all lanes
+		for (; i < count; ++i)
 		{
-			real result = Vector2::dotProduct(vertices[i], direction);
+			const real result = Vector2::dotProduct(vertices[i], direction);
 			if (max < result)
 			{
 				max = result;
-				target = vertices[i];
-				index = i;
+				index = static_cast<Index>(i);
 			}
 		}
-		return std::make_pair(target, index);
+		return std::make_pair(vertices[index], index);
+	}
+
+	std::pair<Vector2, Index> Narrowphase::findFurthestPoint(const std::vector<Vector2>& vertices,
+		const Vector2& direction, const Index& hint)
+	{
+		const Index count = static_cast<Index>(vertices.size());
+		if (count <= HillClimbingThreshold || hint >= count)
+			return findFurthestPoint(vertices, direction);
+
+		//pick the uphill neighbor, projection of convex polygon has one maximum along the loop
+		Index index = hint;
+		real max = Vector2::dotProduct(vertices[index], direction);
+		Index step = 1;
+		Index next = (index + step) % count;
+		real result = Vector2::dotProduct(vertices[next], direction);
+		if (result <= max)
+		{
+			step = count - 1;
+			next = (index + step) % count;
+			result = Vector2::dotProduct(vertices[next], direction);
+		}
+
+		for (Index i = 0; i < count && result > max; ++i)
+		{
+			index = next;
+			max = result;
+			next = (index + step) % count;
+			result = Vector2::dotProduct(vertices[next], direction);
+		}
+		return std::make_pair(vertices[index], index);
 	}
 
 	ContactPair Narrowphase::generateContacts(const ShapePrimitive& shapeA,
-		const ShapePrimitive& shapeB, CollisionInfo& info)
+		const ShapePrimitive& shapeB, CollisionInfo& info, const real& margin)
 	{
 		ContactPair pair;
 		ShapeType typeA = shapeA.shape->type();
 		ShapeType typeB = shapeB.shape->type();
 
-		ShapePrimitive realShapeA = shapeA;
-		ShapePrimitive realShapeB = shapeB;
-		Index idxA = 0;
-		Index idxB = 1;
-
+		//swap by reference, copying primitives would touch the shared cache counter of every pair
 		const bool isSwap = typeA > typeB;
+		const ShapePrimitive& realShapeA = isSwap ? shapeB : shapeA;
+		const ShapePrimitive& realShapeB = isSwap ? shapeA : shapeB;
+		const Index idxA = isSwap ? 1 : 0;
+		const Index idxB = isSwap ? 0 : 1;
 
 		if (isSwap)
 		{
-			std::swap(realShapeA, realShapeB);
 			std::swap(typeA, typeB);
-			std::swap(idxA, idxB);
 			//temporarily negate
 			info.normal.negate();
 		}
@@ -289,24 +687,23 @@ namespace ST
 		//find feature
 		const Feature featureA = findFeatures(info.simplex, info.normal, realShapeA, idxA);
 		const Feature featureB = findFeatures(info.simplex, info.normal, realShapeB, idxB);
-		auto idA = std::pair{ featureA.index[0], featureA.index[1] };
-		pair.ids[0] = reinterpret_cast<uint64_t&>(idA);
-
-		auto idB = std::pair{ featureB.index[0], featureB.index[1] };
-		pair.ids[1] = reinterpret_cast<uint64_t&>(idB);
+		//clipping routines return a fresh pair, ids are assigned after them
+		const std::array<uint64_t, 2> ids = {
+			ContactPair::makeFeatureId(featureA.index[0], featureA.index[1]),
+			ContactPair::makeFeatureId(featureB.index[0], featureB.index[1]) };
 
 		if (typeA == ShapeType::Polygon)
 		{
 			switch (typeB)
 			{
 			case ShapeType::Polygon:
-				pair = clipPolygonPolygon(realShapeA, realShapeB, featureA, featureB, info);
+				pair = clipPolygonPolygon(realShapeA, realShapeB, featureA, featureB, info, margin);
 				break;
 			case ShapeType::Edge:
-				pair = clipPolygonEdge(realShapeA, realShapeB, featureA, featureB, info);
+				pair = clipPolygonEdge(realShapeA, realShapeB, featureA, featureB, info, margin);
 				break;
 			case ShapeType::Capsule:
-				pair = clipPolygonCapsule(realShapeA, realShapeB, featureA, featureB, info);
+				pair = clipPolygonCapsule(realShapeA, realShapeB, featureA, featureB, info, margin);
 				break;
 			case ShapeType::Circle:
 			case ShapeType::Ellipse:
@@ -322,7 +719,7 @@ namespace ST
 				assert(false && "Not support edge and edge.");
 				break;
 			case ShapeType::Capsule:
-				pair = clipEdgeCapsule(realShapeA, realShapeB, featureA, featureB, info);
+				pair = clipEdgeCapsule(realShapeA, realShapeB, featureA, featureB, info, margin);
 				break;
 			case ShapeType::Circle:
 			case ShapeType::Ellipse:
@@ -335,7 +732,7 @@ namespace ST
 			switch (typeB)
 			{
 			case ShapeType::Capsule:
-				pair = clipCapsuleCapsule(realShapeA, realShapeB, featureA, featureB, info);
+				pair = clipCapsuleCapsule(realShapeA, realShapeB, featureA, featureB, info, margin);
 				break;
 			case ShapeType::Circle:
 			case ShapeType::Ellipse:
@@ -344,16 +741,23 @@ namespace ST
 			}
 		}
 		else //round round case
-		{
 			pair = clipRoundRound(realShapeA, realShapeB, featureA, featureB, info);
-			return pair;
-		}
+
+		pair.ids = ids;
+		for (uint32_t i = 0; i < pair.count / 2; ++i)
+			pair.pointIds[i] = ContactPair::makeFeatureId(pointFeature(realShapeA, featureA, pair.points[i * 2]),
+				pointFeature(realShapeB, featureB, pair.points[i * 2 + 1]));
+		//both points snapped to the same vertices, so they are within slop of each other, keep one
+		if (pair.count == 4 && pair.pointIds[0] == pair.pointIds[1])
+			pair.count = 2;
 
 		if (isSwap)
 		{
 			std::swap(pair.points[0], pair.points[1]);
 			std::swap(pair.points[2], pair.points[3]);
 			std::swap(pair.ids[0], pair.ids[1]);
+			for (uint64_t& id : pair.pointIds)
+				id = ContactPair::swapFeatureId(id);
 			//restore normal
 			info.normal.negate();
 		}
@@ -361,7 +765,7 @@ namespace ST
 	}
 
 	CollisionInfo Narrowphase::gjkDistance(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const size_t& iteration)
+		const size_t& iteration, CollisionDebugInfo* debug)
 	{
 		VertexPair result;
 		CollisionInfo info;
@@ -383,38 +787,32 @@ namespace ST
 		info.simplex.addSimplexVertex(vertex);
 
 		reconstructSimplexByVoronoi(info.simplex);
-		info.originalSimplex = info.simplex;
-		//[DEBUG]
-		std::list<SimplexVertexWithOriginDistance>& polytope = info.polytope;
-		//std::list<SimplexVertexWithOriginDistance> polytope;
-
-		buildPolytopeFromSimplex(polytope, info.simplex);
-
-		auto iterStart = polytope.begin();
-		auto iterEnd = polytope.end();
-		auto iterTemp = polytope.begin();
+		if (debug != nullptr)
+			debug->originalSimplex = info.simplex;
+		Polytope polytope;
+		polytope.build(info.simplex);
+		Index edge = 0;
 
 		int errorCount = 0;
 
-		auto reindexSimplex = [&info, &polytope, &iterStart, &iterEnd, &iterTemp]
+		auto reindexSimplex = [&info, &polytope, &edge]
 			{
 				std::swap(info.simplex.vertices[1], info.simplex.vertices[2]);
 				std::swap(info.simplex.vertices[0], info.simplex.vertices[1]);
-				polytope.clear();
-				buildPolytopeFromSimplex(polytope, info.simplex);
-				iterStart = polytope.begin();
-				iterEnd = polytope.end();
-				iterTemp = polytope.begin();
+				polytope.build(info.simplex);
+				edge = 0;
 			};
 
 		int sameDistCount = 0;
 
-		for (Index iter = 0; iter < iteration; ++iter)
+		Index iter = 0;
+		for (; iter < iteration; ++iter)
 		{
 			//indices of closest edge are set to 0 and 1
 			direction = findDirectionByEdge(info.simplex.vertices[0], info.simplex.vertices[1], true);
 
-			vertex = support(shapeA, shapeB, direction);
+			vertex = support(shapeA, shapeB, direction, info.simplex.vertices[0].index[0],
+				info.simplex.vertices[0].index[1]);
 
 			//cannot find any new vertex
 			if (info.simplex.contains(vertex))
@@ -422,24 +820,26 @@ namespace ST
 				if (sameDistCount == 1)
 				{
 					//check edge case
-					polytopeIterNext(iterStart, polytope);
-					iterEnd = iterStart;
-					polytopeIterPrev(iterEnd, polytope);
-					iterTemp = iterStart;
-					polytopeIterNext(iterTemp, polytope);
-
-					info.simplex.vertices[0] = iterStart->vertex;
-					info.simplex.vertices[1] = iterTemp->vertex;
+					edge = polytope.next(edge);
+
+					info.simplex.vertices[0] = polytope.vertex(edge);
+					info.simplex.vertices[1] = polytope.vertex(polytope.next(edge));
 					iter--;
 					//do not process anymore
 					sameDistCount = -1;
 					continue;
 				}
 				if (polytope.size() >= 4) //polytope has been expanded, terminate the loop
+				{
+					RECORD_QUERY(GjkDistance, iter + 1, Converged);
 					break;
+				}
 
 				if (errorCount == 3) //fail to rewind simplex, terminate
+				{
+					RECORD_QUERY(GjkDistance, iter + 1, Degenerate);
 					break;
+				}
 
 				reindexSimplex();
 
@@ -451,20 +851,20 @@ namespace ST
 			}
 			//convex test, make sure polytope is always convex
 
-			auto itA = iterStart;
+			const Index indexA = edge;
+			const Index indexB = polytope.next(indexA);
+			const Index indexC = polytope.next(indexB);
 
-			auto itB = itA;
-			polytopeIterNext(itB, polytope);
+			const Vector2& a = polytope.vertex(indexA).result;
+			const Vector2& b = polytope.vertex(indexB).result;
+			const Vector2& c = polytope.vertex(indexC).result;
 
-			auto itC = itB;
-			polytopeIterNext(itC, polytope);
-
-			const Vector2 ab = itB->vertex.result - itA->vertex.result;
-			const Vector2 bc = itC->vertex.result - itB->vertex.result;
+			const Vector2 ab = b - a;
+			const Vector2 bc = c - b;
 			const real res1 = Vector2::crossProduct(ab, bc);
 
-			const Vector2 an = vertex.result - itA->vertex.result;
-			const Vector2 nb = itB->vertex.result - vertex.result;
+			const Vector2 an = vertex.result - a;
+			const Vector2 nb = b - vertex.result;
 			const real res2 = Vector2::crossProduct(an, nb);
 
 			const real res3 = Vector2::crossProduct(nb, bc);
@@ -474,10 +874,16 @@ namespace ST
 			if (!validConvexity) //invalid vertex
 			{
 				if (polytope.size() >= 4) //if polytope is expanded, terminate the loop
+				{
+					RECORD_QUERY(GjkDistance, iter + 1, Converged);
 					break;
+				}
 
 				if (errorCount == 3) //fail to rewind simplex, terminate
+				{
+					RECORD_QUERY(GjkDistance, iter + 1, Degenerate);
 					break;
+				}
 
 				//try to rewind
 				reindexSimplex();
@@ -487,52 +893,29 @@ namespace ST
 			}
 
 			//then insert new vertex
+			const Index inserted = polytope.insert(indexA, vertex);
+			if (inserted == UINT32_MAX)
+			{
+				RECORD_QUERY(GjkDistance, iter + 1, Degenerate);
+				break;
+			}
 
-			SimplexVertexWithOriginDistance pair;
-			pair.vertex = vertex;
-			const Vector2 t1 = GeometryAlgorithm2D::pointToLineSegment(itA->vertex.result, vertex.result, { 0, 0 });
-			const real dist1 = t1.lengthSquare();
-			const Vector2 t2 = GeometryAlgorithm2D::pointToLineSegment(vertex.result, itB->vertex.result, { 0, 0 });
-			const real dist2 = t2.lengthSquare();
-
-			itA->distance = dist1;
-			pair.distance = dist2;
-			polytope.insert(itB, pair);
 			//TODO: if dist1 == dist2, and dist1 cannot be extended and dist2 can be extended.
-			sameDistCount = realEqual(dist1, dist2) ? sameDistCount + 1 : sameDistCount;
-
-			//set to begin
-			iterTemp = iterStart;
+			sameDistCount = realEqual(polytope.distance(indexA), polytope.distance(inserted))
+				? sameDistCount + 1 : sameDistCount;
 
-			//find shortest distance and set iterStart
-			real minDistance = Constant::Max;
-			auto iterTarget = iterStart;
-			while (true)
-			{
-				if (iterTemp->distance < minDistance)
-				{
-					minDistance = iterTemp->distance;
-					iterTarget = iterTemp;
-				}
-				polytopeIterNext(iterTemp, polytope);
-				if (iterTemp == iterStart)
-					break;
-			}
-			iterStart = iterTarget;
-			iterEnd = iterTarget;
-			polytopeIterPrev(iterEnd, polytope);
-
-			//set to begin
-			iterTemp = iterStart;
-			polytopeIterNext(iterTemp, polytope);
-			//reset simplex
-			info.simplex.vertices[0] = iterStart->vertex;
-			info.simplex.vertices[1] = iterTemp->vertex;
+			//reset simplex to closest edge
+			edge = polytope.closestEdge(indexA);
+			info.simplex.vertices[0] = polytope.vertex(edge);
+			info.simplex.vertices[1] = polytope.vertex(polytope.next(edge));
 			errorCount = 0;
 		}
-		auto idxStart = std::distance(polytope.begin(), iterStart);
-		polytopeIterNext(iterStart, polytope);
-		auto idxNext = std::distance(polytope.begin(), iterStart);
+		if (iter == iteration)
+			RECORD_QUERY(GjkDistance, iter, IterationLimit);
+
+		if (debug != nullptr)
+			polytope.exportTo(debug->polytope);
+
 		info.simplex.removeEnd();
 		//Convex combination for calculating distance points
 		//https://dyn4j.org/2010/04/gjk-distance-closest-points/
@@ -570,6 +953,230 @@ namespace ST
 		return info;
 	}
 
+	TimeOfImpact Narrowphase::timeOfImpact(const ShapePrimitive& shapeA, const Sweep& sweepA,
+		const ShapePrimitive& shapeB, const Sweep& sweepB, const real& tolerance, const size_t& iteration)
+	{
+		assert(shapeA.shape != nullptr && shapeB.shape != nullptr);
+		TimeOfImpact result;
+
+		//cache is not valid along the sweep, only shape is taken
+		ShapePrimitive primitiveA;
+		primitiveA.shape = shapeA.shape;
+		ShapePrimitive primitiveB;
+		primitiveB.shape = shapeB.shape;
+
+		const Vector2 translation = (sweepA.end.position - sweepA.start.position)
+			- (sweepB.end.position - sweepB.start.position);
+		const real angularBoundA = std::fabs(sweepA.end.rotation - sweepA.start.rotation)
+			* boundingRadius(shapeA.shape) * Math::max(sweepA.start.scale, sweepA.end.scale);
+		const real angularBoundB = std::fabs(sweepB.end.rotation - sweepB.start.rotation)
+			* boundingRadius(shapeB.shape) * Math::max(sweepB.start.scale, sweepB.end.scale);
+
+		//stop a bit inside the tolerance, so that the last step does not fall short of it by rounding
+		const real target = tolerance * real(0.5);
+		real time = 0;
+
+		for (Index iter = 0; iter < iteration; ++iter)
+		{
+			result.iterations = iter + 1;
+			primitiveA.transform = sweepA.at(time);
+			primitiveB.transform = sweepB.at(time);
+
+			//already overlapping, e.g. at the start of sweep
+			if (gjk(primitiveA, primitiveB).isContainOrigin)
+			{
+				result.isHit = true;
+				result.time = time;
+				const Vector2 centerDelta = primitiveB.transform.position - primitiveA.transform.position;
+				if (!centerDelta.fuzzyEqual({ 0, 0 }))
+					result.normal = centerDelta.normal();
+				return result;
+			}
+
+			const CollisionInfo info = gjkDistance(primitiveA, primitiveB);
+			const Vector2 delta = info.pair.pointB - info.pair.pointA;
+			if (!realEqual(info.penetration, 0))
+				result.normal = delta / info.penetration;
+
+			//gjkDistance may overestimate, separation along normal never does. Taking the smaller one keeps
+			//every step from passing the contact.
+			const real separation = -support(primitiveA, primitiveB, result.normal).result.dot(result.normal);
+			const real distance = Math::min(info.penetration, separation);
+
+			if (distance <= tolerance)
+			{
+				result.isHit = true;
+				result.time = time;
+				return result;
+			}
+
+			//upper bound of closing speed along normal over the whole sweep
+			const real approach = translation.dot(result.normal) + angularBoundA + angularBoundB;
+			if (approach <= Constant::GeometryEpsilon)
+				return TimeOfImpact{ false, 1, result.normal, result.iterations };
+
+			time += (distance - target) / approach;
+			if (time >= 1)
+				return TimeOfImpact{ false, 1, result.normal, result.iterations };
+		}
+
+		//not converged, the last time is still separated
+		result.isHit = true;
+		result.time = time;
+		return result;
+	}
+
+	ShapeCast Narrowphase::shapeCast(const ShapePrimitive& shapeA, const Vector2& translationA,
+		const ShapePrimitive& shapeB, const real& tolerance, const size_t& iteration)
+	{
+		ShapeCast result;
+		Simplex simplex;
+		std::array<real, 3> weights{ 1, 0, 0 };
+		real lambda = 0;
+
+		//A moved by lambda * translationA hits B when origin is in (A - B) + lambda * translationA.
+		//v is the point of that set closest to origin found so far, start from any point of A - B.
+		Vector2 v = support(shapeA, shapeB, -translationA).result;
+
+		Index iter = 0;
+		for (; iter < iteration && v.lengthSquare() > tolerance * tolerance; ++iter)
+		{
+			const SimplexVertex vertex = support(shapeA, shapeB, -v, simplex.vertices[0].index[0],
+				simplex.vertices[0].index[1]);
+			const Vector2 direction = v.normal();
+
+			//A - B lies on the positive side of the plane through vertex with normal direction,
+			//move the ray origin onto the plane if it is still outside
+			const real vp = direction.dot(vertex.result);
+			const real vr = direction.dot(translationA);
+			if (vp + lambda * vr > 0)
+			{
+				if (vr >= 0)
+					return result;
+
+				lambda = -vp / vr;
+				if (lambda > 1)
+					return result;
+
+				//plane that stops the ray, v itself is too short to give a direction at the end
+				result.normal = direction;
+				//vertices found before are shifted by old lambda
+				simplex.removeAll();
+			}
+
+			simplex.addSimplexVertex(SimplexVertex(vertex.point[0] + translationA * lambda, vertex.point[1],
+				vertex.index[0], vertex.index[1]));
+
+			v = closestPointToOrigin(simplex, weights);
+			if (simplex.count == 3)
+				break;
+		}
+
+		result.isHit = true;
+		result.fraction = lambda;
+		result.iterations = iter;
+
+		//touching or overlapping at the start
+		if (iter == 0)
+		{
+			result.point = support(shapeA, shapeB, -translationA).point[1];
+			return result;
+		}
+
+		for (Index i = 0; i < simplex.count; ++i)
+			result.point += simplex.vertices[i].point[1] * weights[i];
+
+		return result;
+	}
+
+	bool Narrowphase::distance(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const real& maxDistance,
+		DistanceResult& result, const size_t& iteration)
+	{
+		Vector2 direction = shapeA.transform.position - shapeB.transform.position;
+		if (direction.fuzzyEqual({ 0, 0 }))
+			direction.set(1, 1);
+
+		Simplex simplex;
+		std::array<real, 3> weights{ 1, 0, 0 };
+		simplex.addSimplexVertex(support(shapeA, shapeB, direction.negative()));
+		Vector2 v = simplex.vertices[0].result;
+
+		for (Index iter = 0; iter < iteration; ++iter)
+		{
+			if (v.fuzzyEqual({ 0, 0 }))
+				break;
+
+			const SimplexVertex vertex = support(shapeA, shapeB, v.negative(), simplex.vertices[0].index[0],
+				simplex.vertices[0].index[1]);
+
+			//A - B lies on the far side of the support plane, its distance to origin bounds distance from below
+			const real upperBound = v.length();
+			const real lowerBound = vertex.result.dot(v) / upperBound;
+			if (lowerBound > maxDistance)
+				return false;
+
+			if (upperBound - lowerBound <= Constant::GeometryEpsilon * upperBound || simplex.contains(vertex))
+				break;
+
+			simplex.addSimplexVertex(vertex);
+			v = closestPointToOrigin(simplex, weights);
+			if (simplex.count == 3)
+				break;
+		}
+
+		//overlapping, or touching within epsilon
+		if (simplex.count == 3 || v.fuzzyEqual({ 0, 0 }))
+		{
+			result.distance = 0;
+			result.pair = VertexPair();
+			return true;
+		}
+
+		result.distance = v.length();
+		if (result.distance > maxDistance)
+			return false;
+
+		result.pair = VertexPair();
+		for (Index i = 0; i < simplex.count; ++i)
+		{
+			result.pair.pointA += simplex.vertices[i].point[0] * weights[i];
+			result.pair.pointB += simplex.vertices[i].point[1] * weights[i];
+		}
+		return true;
+	}
+
+	std::vector<DistanceResult> Narrowphase::distanceBatch(std::span<const ShapePair> pairs, const real& maxDistance)
+	{
+		std::vector<DistanceResult> result;
+		ThreadPool& pool = ThreadPool::instance();
+
+		//most pairs are usually out of range, so every chunk collects its hits and they are merged in order
+		std::vector<std::vector<DistanceResult>> buffers(pool.concurrency());
+		const size_t chunkCount = pool.parallelFor(pairs.size(), NarrowphaseBatchGrainSize,
+			[&pairs, &maxDistance, &buffers](size_t begin, size_t end, size_t chunkIndex)
+			{
+				auto& local = buffers[chunkIndex];
+				for (size_t i = begin; i < end; ++i)
+				{
+					DistanceResult distanceResult;
+					if (!distance(*pairs[i].bodyA, *pairs[i].bodyB, maxDistance, distanceResult))
+						continue;
+					distanceResult.index = i;
+					local.emplace_back(distanceResult);
+				}
+			});
+
+		size_t total = 0;
+		for (size_t i = 0; i < chunkCount; ++i)
+			total += buffers[i].size();
+
+		result.reserve(total);
+		for (size_t i = 0; i < chunkCount; ++i)
+			result.insert(result.end(), buffers[i].begin(), buffers[i].end());
+
+		return result;
+	}
+
 	void Narrowphase::reconstructSimplexByVoronoi(Simplex& simplex)
 	{
 		//use barycentric coordinates to check contains origin and find closest edge
@@ -598,7 +1205,7 @@ namespace ST
 		 * solve for u,v,w
 		 */
 		const real det = a.y * b.x - a.x * b.y + a.x * c.y - a.y * c.x + b.y * c.x - c.y * b.x;
-		assert(det != 0.0f);
+		assert(det != 0);
 		const real u = (b.y * c.x - c.y * b.x) / det;
 		const real v = (c.y * a.x - a.y * c.x) / det;
 		const real w = 1 - u - v;
@@ -636,7 +1243,7 @@ namespace ST
 			direction.set(-direction.y + static_cast<real>(i), -direction.x - static_cast<real>(i));
 			SimplexVertex v = support(shapeA, shapeB, direction);
 			simplex.vertices[0] = v;
-			direction.set(-direction.y - static_cast<real>(i) - 0.5f, -direction.x + static_cast<real>(i) + 0.5f);
+			direction.set(-direction.y - static_cast<real>(i) - real(0.5), -direction.x + static_cast<real>(i) + real(0.5));
 			v = support(shapeA, shapeB, direction);
 			simplex.vertices[1] = v;
 
@@ -662,10 +1269,13 @@ namespace ST
 				//find neighbor index
 
 				auto polygon = static_cast<const Polygon*>(shape.shape);
-				const Vector2 n = shape.transform.inverseRotatePoint(normal);
+				//compare in world space if cached, otherwise in local space of polygon
+				const ShapeCache* cache = shape.validCache();
+				const std::vector<Vector2>& vertices = cache != nullptr ? cache->vertices : polygon->vertices();
+				const Vector2 n = cache != nullptr ? normal : shape.transform.inverseRotatePoint(normal);
 
 				const Index idxCurr = simplex.vertices[0].index[AorB];
-				const size_t realSize = polygon->vertices().size();
+				const size_t realSize = vertices.size();
 				//TODO: change vertex convention of polygon 
 				const Index idxNext = (idxCurr + 1) % realSize;
 				//if idx = 0 then unsigned number overflow, so minus operation is needed to be set aside.
@@ -673,8 +1283,8 @@ namespace ST
 
 
 				//check most perpendicular
-				const Vector2 ab = (polygon->vertices()[idxNext] - polygon->vertices()[idxCurr]).normal();
-				const Vector2 ac = (polygon->vertices()[idxCurr] - polygon->vertices()[idxPrev]).normal();
+				const Vector2 ab = (vertices[idxNext] - vertices[idxCurr]).normal();
+				const Vector2 ac = (vertices[idxCurr] - vertices[idxPrev]).normal();
 
 
 				const real dot1 = Math::abs(ab.dot(n));
@@ -698,7 +1308,7 @@ namespace ST
 	}
 
 	ContactPair Narrowphase::clipTwoEdge(const Vector2& va1, const Vector2& va2, const Vector2& vb1, const Vector2& vb2,
-		CollisionInfo& info)
+		CollisionInfo& info, const real& margin)
 	{
 		std::array<ClipVertex, 2> incEdge;
 		std::array<Vector2, 2> refEdge = { va1, va2 };
@@ -723,11 +1333,11 @@ namespace ST
 			refNormal.negate();
 		}
 
-		return clipIncidentEdge(incEdge, refEdge, refNormal, swap);
+		return clipIncidentEdge(incEdge, refEdge, refNormal, swap, margin);
 	}
 
-	ContactPair Narrowphase::clipIncidentEdge(std::array<ClipVertex, 2>& incEdge, std::array<Vector2, 2> refEdge,
-		const Vector2& normal, bool swap)
+	ContactPair Narrowphase::clipIncidentEdge(std::array<ClipVertex, 2>& incEdge, const std::array<Vector2, 2>& refEdge,
+		const Vector2& normal, bool swap, const real& margin)
 	{
 		ContactPair pair;
 		const Vector2 refEdgeDir = (refEdge[1] - refEdge[0]).normal();
@@ -787,11 +1397,13 @@ namespace ST
 			incEdge[1].clipperVertex = refEdge[1];
 		}
 
-		//check ref normal region
-		incEdge[0].isFinalValid = (incEdge[0].vertex - refEdge[0]).dot(refEdgeNormal) >= 0;
-		incEdge[1].isFinalValid = (incEdge[1].vertex - refEdge[0]).dot(refEdgeNormal) >= 0;
+		//check ref normal region, speculative points in front of reference edge within margin are kept
+		incEdge[0].isFinalValid = (incEdge[0].vertex - refEdge[0]).dot(refEdgeNormal) >= -margin;
+		incEdge[1].isFinalValid = (incEdge[1].vertex - refEdge[0]).dot(refEdgeNormal) >= -margin;
 
-		assert(incEdge[0].isFinalValid || incEdge[1].isFinalValid && "Invalid features.");
+		//features of gjkDistance may give no point within margin, the pair has no speculative contact then
+		if (!incEdge[0].isFinalValid && !incEdge[1].isFinalValid)
+			return pair;
 
 		if (incEdge[0].isFinalValid && !incEdge[1].isFinalValid)
 		{
@@ -827,7 +1439,7 @@ namespace ST
 
 			pair.addContact(refContact2, incContact2);
 		}
-		else
+		else if (incEdge[0].isFinalValid && incEdge[1].isFinalValid)
 		{
 			//both valid, continue to check isClip
 			Vector2 incContact1 = incEdge[0].vertex;
@@ -860,43 +1472,37 @@ namespace ST
 	}
 
 	ContactPair Narrowphase::clipPolygonPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
+		const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin)
 	{
-		auto polygonA = static_cast<const Polygon*>(shapeA.shape);
-		auto polygonB = static_cast<const Polygon*>(shapeB.shape);
+		const Vector2 va1 = polygonVertex(shapeA, featureA.index[0]);
+		const Vector2 va2 = polygonVertex(shapeA, featureA.index[1]);
 
-		const Vector2 va1 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[0]]);
-		const Vector2 va2 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[1]]);
+		const Vector2 vb1 = polygonVertex(shapeB, featureB.index[0]);
+		const Vector2 vb2 = polygonVertex(shapeB, featureB.index[1]);
 
-		const Vector2 vb1 = shapeB.transform.translatePoint(polygonB->vertices()[featureB.index[0]]);
-		const Vector2 vb2 = shapeB.transform.translatePoint(polygonB->vertices()[featureB.index[1]]);
-
-		return clipTwoEdge(va1, va2, vb1, vb2, info);
+		return clipTwoEdge(va1, va2, vb1, vb2, info, margin);
 	}
 
 	ContactPair Narrowphase::clipPolygonEdge(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
+		const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin)
 	{
-		auto polygonA = static_cast<const Polygon*>(shapeA.shape);
 		auto edgeB = static_cast<const Edge*>(shapeB.shape);
 
-		const Vector2 va1 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[0]]);
-		const Vector2 va2 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[1]]);
+		const Vector2 va1 = polygonVertex(shapeA, featureA.index[0]);
+		const Vector2 va2 = polygonVertex(shapeA, featureA.index[1]);
 		const Vector2 vb1 = shapeB.transform.translatePoint(edgeB->startPoint());
 		const Vector2 vb2 = shapeB.transform.translatePoint(edgeB->endPoint());
 
-		return clipTwoEdge(va1, va2, vb1, vb2, info);
+		return clipTwoEdge(va1, va2, vb1, vb2, info, margin);
 	}
 
 	ContactPair Narrowphase::clipPolygonCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
+		const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin)
 	{
 		ContactPair pair;
 
-		auto polygonA = static_cast<const Polygon*>(shapeA.shape);
-
-		const Vector2 va1 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[0]]);
-		const Vector2 va2 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[1]]);
+		const Vector2 va1 = polygonVertex(shapeA, featureA.index[0]);
+		const Vector2 va2 = polygonVertex(shapeA, featureA.index[1]);
 
 		const Vector2 localB1 = shapeB.transform.inverseTranslatePoint(featureB.vertex[0]);
 
@@ -928,7 +1534,7 @@ namespace ST
 
 			Vector2 vb2 = shapeB.transform.translatePoint(localB);
 
-			pair = clipTwoEdge(va1, va2, featureB.vertex[0], vb2, info);
+			pair = clipTwoEdge(va1, va2, featureB.vertex[0], vb2, info, margin);
 		}
 		else
 		{
@@ -951,7 +1557,7 @@ namespace ST
 			Vector2 b = vb2 - va1;
 
 			if (!Math::sameSign(b.dot(va2 - va1), b.dot(vb2 - va2)) &&
-				GeometryAlgorithm2D::isPointOnSameSide(va1, va2, va1 + info.normal, vb2))
+				GeometryAlgorithm2D::isPointOnSameSide(va1, va2, va1 + info.normal, vb2 + info.normal * margin))
 				pair.addContact(GeometryAlgorithm2D::pointToLineSegment(va1, va2, vb2), vb2);
 		}
 
@@ -961,9 +1567,8 @@ namespace ST
 	ContactPair Narrowphase::clipPolygonRound(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
 		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
 	{
-		auto polygonA = static_cast<const Polygon*>(shapeA.shape);
-		const Vector2 va1 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[0]]);
-		const Vector2 va2 = shapeA.transform.translatePoint(polygonA->vertices()[featureA.index[1]]);
+		const Vector2 va1 = polygonVertex(shapeA, featureA.index[0]);
+		const Vector2 va2 = polygonVertex(shapeA, featureA.index[1]);
 
 		ContactPair pair = clipEdgeVertex(va1, va2, featureB.vertex[0], info);
 
@@ -971,7 +1576,7 @@ namespace ST
 	}
 
 	ContactPair Narrowphase::clipEdgeCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
+		const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin)
 	{
 		ContactPair pair;
 		const Vector2 localB1 = shapeB.transform.inverseTranslatePoint(featureB.vertex[0]);
@@ -1009,7 +1614,7 @@ namespace ST
 			Vector2 vb2 = shapeB.transform.translatePoint(localB);
 
 
-			pair = clipTwoEdge(va1, va2, featureB.vertex[0], vb2, info);
+			pair = clipTwoEdge(va1, va2, featureB.vertex[0], vb2, info, margin);
 		}
 		else
 		{
@@ -1032,7 +1637,7 @@ namespace ST
 			Vector2 b = vb2 - va1;
 
 			if (!Math::sameSign(b.dot(va2 - va1), b.dot(vb2 - va2)) &&
-				GeometryAlgorithm2D::isPointOnSameSide(va1, va2, va1 + info.normal, vb2))
+				GeometryAlgorithm2D::isPointOnSameSide(va1, va2, va1 + info.normal, vb2 + info.normal * margin))
 				pair.addContact(GeometryAlgorithm2D::pointToLineSegment(va1, va2, vb2), vb2);
 		}
 
@@ -1052,7 +1657,7 @@ namespace ST
 	}
 
 	ContactPair Narrowphase::clipCapsuleCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-		const Feature& featureA, const Feature& featureB, CollisionInfo& info)
+		const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin)
 	{
 		ContactPair pair;
 
@@ -1171,7 +1776,7 @@ namespace ST
 			const Vector2 va2 = shapeA.transform.translatePoint(localA);
 			const Vector2 vb2 = shapeB.transform.translatePoint(localB);
 
-			pair = clipTwoEdge(va1, va2, vb1, vb2, info);
+			pair = clipTwoEdge(va1, va2, vb1, vb2, info, margin);
 			break;
 		}
 		return pair;
@@ -1207,6 +1812,18 @@ namespace ST
 		//need to fix old info
 		ContactPair pair;
 
+		//speculative contact, closest points are the contact. They are in the order of the original pair,
+		//generateContacts may have swapped shapes and negated normal, so order them by current normal
+		if (info.penetration < 0)
+		{
+			Vector2 pointA = info.pair.pointA;
+			Vector2 pointB = info.pair.pointB;
+			if ((pointA - pointB).dot(info.normal) < 0)
+				std::swap(pointA, pointB);
+			pair.addContact(pointA, pointB);
+			return pair;
+		}
+
 		const Vector2 v1 = (info.simplex.vertices[0].point[1] - info.simplex.vertices[0].point[0]).normal();
 		const Vector2 v2 = (info.simplex.vertices[1].point[1] - info.simplex.vertices[1].point[0]).normal();
 
@@ -1248,35 +1865,108 @@ namespace ST
 		return pair;
 	}
 
-	void Narrowphase::polytopeIterNext(std::list<SimplexVertexWithOriginDistance>::iterator& targetIter,
-		std::list<SimplexVertexWithOriginDistance>& list)
+	Vector2 Narrowphase::polygonVertex(const ShapePrimitive& shape, const Index& index)
+	{
+		if (const ShapeCache* cache = shape.validCache())
+			return cache->vertices[index];
+		return shape.transform.translatePoint(static_cast<const Polygon*>(shape.shape)->vertices()[index]);
+	}
+
+	Index Narrowphase::pointFeature(const ShapePrimitive& shape, const Feature& feature, const Vector2& point)
+	{
+		//clipped points lie at a vertex of one shape or the other, within slop
+		const real tolerance = Constant::LinearSlop * Constant::LinearSlop;
+		switch (shape.shape->type())
+		{
+		case ShapeType::Polygon:
+		{
+			const Index count = static_cast<Index>(static_cast<const Polygon*>(shape.shape)->vertices().size());
+			for (const Index& index : feature.index)
+			{
+				if ((polygonVertex(shape, index) - point).lengthSquare() < tolerance)
+					return index | ContactPair::VertexFeature;
+			}
+			return (feature.index[0] + 1) % count == feature.index[1] ? feature.index[0] : feature.index[1];
+		}
+		case ShapeType::Edge:
+		{
+			const Edge* edge = static_cast<const Edge*>(shape.shape);
+			if ((shape.transform.translatePoint(edge->startPoint()) - point).lengthSquare() < tolerance)
+				return ContactPair::VertexFeature;
+			if ((shape.transform.translatePoint(edge->endPoint()) - point).lengthSquare() < tolerance)
+				return 1 | ContactPair::VertexFeature;
+			return 0;
+		}
+		case ShapeType::Capsule:
+		{
+			//same core segment as the analytic path, caps are its vertices and sides are its two edges
+			const Capsule* capsule = static_cast<const Capsule*>(shape.shape);
+			const real halfWidth = capsule->halfWidth();
+			const real halfHeight = capsule->halfHeight();
+			const Vector2 end = halfWidth >= halfHeight ? Vector2(halfWidth - halfHeight, 0)
+				: Vector2(0, halfHeight - halfWidth);
+			const real length = end.length();
+			const Vector2 local = shape.transform.inverseTranslatePoint(point);
+			if (length < Constant::GeometryEpsilon)
+				return UINT32_MAX;
+
+			const real t = local.dot(end) / length;
+			if (t > length - Constant::LinearSlop)
+				return ContactPair::VertexFeature;
+			if (t < Constant::LinearSlop - length)
+				return 1 | ContactPair::VertexFeature;
+			return local.cross(end) > 0 ? 0 : 1;
+		}
+		default:
+			return UINT32_MAX;
+		}
+	}
+
+	void Narrowphase::collideBatch(std::span<const ShapePair> pairs, ContactBuffer& buffer, const real& margin)
 	{
-		++targetIter;
-		if (targetIter == list.end())
-			targetIter = list.begin();
+		buffer.resize(pairs.size());
+		ThreadPool::instance().parallelFor(pairs.size(), NarrowphaseBatchGrainSize, [&](size_t begin, size_t end, size_t)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					CollisionInfo info;
+					ContactPair contacts;
+					const bool isColliding = collide(*pairs[i].bodyA, *pairs[i].bodyB, info, contacts, nullptr, margin);
+					buffer.isColliding[i] = isColliding;
+					buffer.normals[i] = info.normal;
+					buffer.penetrations[i] = isColliding ? info.penetration : 0;
+					buffer.points[i] = contacts.points;
+					buffer.ids[i] = contacts.ids;
+					buffer.pointIds[i] = contacts.pointIds;
+					buffer.counts[i] = isColliding ? contacts.count : 0;
+				}
+			});
 	}
 
-	void Narrowphase::polytopeIterPrev(std::list<SimplexVertexWithOriginDistance>::iterator& targetIter,
-		std::list<SimplexVertexWithOriginDistance>& list)
+	void ContactBuffer::resize(size_t size)
 	{
-		if (targetIter == list.begin())
-			targetIter = list.end();
-		--targetIter;
+		isColliding.resize(size);
+		normals.resize(size);
+		penetrations.resize(size);
+		points.resize(size);
+		ids.resize(size);
+		pointIds.resize(size);
+		counts.resize(size);
 	}
 
-	void Narrowphase::buildPolytopeFromSimplex(std::list<SimplexVertexWithOriginDistance>& polytope,
-		const Simplex& simplex)
+	size_t ContactBuffer::size() const
 	{
-		for (auto iter = simplex.vertices.begin(); iter != simplex.vertices.end(); ++iter)
-		{
-			auto next = iter + 1;
-			if (next == simplex.vertices.end())
-				next = simplex.vertices.begin();
-			SimplexVertexWithOriginDistance pair;
-			pair.vertex = *iter;
-			pair.distance = GeometryAlgorithm2D::pointToLineSegment(iter->result, next->result, { 0, 0 })
-				.lengthSquare(); //use lengthSquare() to avoid sqrt
-			polytope.emplace_back(pair);
-		}
+		return isColliding.size();
+	}
+
+	ContactPair ContactBuffer::contactPair(size_t index) const
+	{
+		assert(index < size());
+		ContactPair pair;
+		pair.points = points[index];
+		pair.ids = ids[index];
+		pair.pointIds = pointIds[index];
+		pair.count = counts[index];
+		return pair;
 	}
 }
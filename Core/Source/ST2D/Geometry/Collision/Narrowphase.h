@@ -2,17 +2,12 @@
 
 #include "ST2D/Geometry/Algorithms/Algorithm2D.h"
 #include "ST2D/Geometry/Shape/Shape.h"
-#include "Simplex.h"
+#include "Polytope.h"
+#include "PairTable.h"
 
 
 namespace ST
 {
-	struct ST_API SimplexVertexWithOriginDistance
-	{
-		SimplexVertex vertex;
-		real distance = 0.0f;
-	};
-
 	struct ST_API Feature
 	{
 		//circle and ellipse, use index 0
@@ -39,15 +34,42 @@ namespace ST
 		//	points[2]: pointA
 		//	points[3]: pointB
 		std::array<Vector2, 4> points;
+		//features of shape A and shape B
 		std::array<uint64_t, 2> ids{};
+		//key of each contact point, stable across frames while the touching features stay the same.
+		//Low half is the feature of A and high half the feature of B, like b2ContactFeature of box2d:
+		//an edge is its first vertex in winding order, a vertex is its index | VertexFeature,
+		//circle and ellipse are UINT32_MAX
+		std::array<uint64_t, 2> pointIds{};
 		uint32_t count = 0;
 
+		static constexpr Index VertexFeature = 0x80000000u;
+
 		void addContact(const Vector2& pointA, const Vector2& pointB)
 		{
 			assert(count <= 4);
 			points[count++] = pointA;
 			points[count++] = pointB;
 		}
+
+		void addContact(const Vector2& pointA, const Vector2& pointB, const uint64_t& pointId)
+		{
+			assert(count <= 4);
+			pointIds[count / 2] = pointId;
+			addContact(pointA, pointB);
+		}
+
+		//pack two feature indices into one id, same layout as std::pair<Index, Index>
+		static uint64_t makeFeatureId(const Index& first, const Index& second)
+		{
+			return static_cast<uint64_t>(second) << 32 | static_cast<uint64_t>(first);
+		}
+
+		//point id seen from the other shape
+		static uint64_t swapFeatureId(const uint64_t& id)
+		{
+			return id >> 32 | id << 32;
+		}
 	};
 
 
@@ -75,30 +97,243 @@ namespace ST
 		real penetration = 0;
 		Simplex simplex;
 		VertexPair pair;
-		//[Debug]
+	};
+
+	/**
+	 * \brief [Debug] Intermediate data of epa and gjkDistance for visualization.
+	 * Kept out of CollisionInfo so that the result stays trivially copyable, it is only filled when passed in.
+	 */
+	struct ST_API CollisionDebugInfo
+	{
+		//simplex that the expansion starts from
 		Simplex originalSimplex;
-		std::list<SimplexVertexWithOriginDistance> polytope;
+		//final polytope in winding order
+		std::vector<SimplexVertexWithOriginDistance> polytope;
+	};
+
+	/// <summary>
+	/// Structure of arrays storage of Narrowphase::collideBatch results, slot i belongs to pair i.
+	/// Capacity is kept between frames, so a steady pair count does not allocate.
+	/// </summary>
+	struct ST_API ContactBuffer
+	{
+		//uint8_t instead of bool, so that workers can write neighboring slots. Also set for speculative contacts
+		std::vector<uint8_t> isColliding;
+		//same convention as CollisionInfo, penetration is negative for speculative contacts
+		std::vector<Vector2> normals;
+		std::vector<real> penetrations;
+		//same layout as ContactPair
+		std::vector<std::array<Vector2, 4>> points;
+		std::vector<std::array<uint64_t, 2>> ids;
+		std::vector<std::array<uint64_t, 2>> pointIds;
+		std::vector<uint32_t> counts;
+
+		void resize(size_t size);
+		size_t size()const;
+		ContactPair contactPair(size_t index)const;
+	};
+
+	struct ST_API TimeOfImpact
+	{
+		bool isHit = false;
+		//fraction of the sweep, 1 if there is no hit
+		real time = 1;
+		//points from A to B at time
+		Vector2 normal;
+		Index iterations = 0;
+	};
+
+	struct ST_API ShapeCast
+	{
+		bool isHit = false;
+		//fraction of translation, 1 if there is no hit
+		real fraction = 1;
+		//points from B to A, zero if shapes overlap at the start
+		Vector2 normal;
+		//hit point on B
+		Vector2 point;
+		Index iterations = 0;
+	};
+
+	struct ST_API DistanceResult
+	{
+		//index into pairs of Narrowphase::distanceBatch
+		size_t index = 0;
+		//0 if shapes overlap
+		real distance = 0;
+		//closest points, only meaningful if distance > 0
+		VertexPair pair;
 	};
 
 	class ST_API Narrowphase
 	{
 	public:
 		static Simplex gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const size_t& iteration = 30);
+		/// <summary>
+		/// Warm started gjk. Starts from the simplex stored in cache by the last call, if it is still valid,
+		/// then stores the result back. Resting pairs usually terminate without any support query,
+		/// because their cached triangle still contains origin. A cached triangle that does not starts over.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="cache">simplex of the last call of this pair, empty on first call</param>
+		/// <param name="iteration"></param>
+		/// <returns></returns>
+		static Simplex gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, SimplexCache& cache,
+			const size_t& iteration = 30);
+		/// <summary>
+		/// Warm started gjk with cache looked up by PairID of both shapes.
+		/// Entries are never removed here, erase them when the pair ends, e.g. on PairManager::endPairs.
+		/// </summary>
+		static Simplex gjk(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			PairTable<SimplexCache>& caches, const size_t& iteration = 30);
 		static CollisionInfo epa(const Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const size_t& iteration = 30, const real& epsilon = Constant::GeometryEpsilon);
+			const size_t& iteration = 30, const real& epsilon = Constant::GeometryEpsilon,
+			CollisionDebugInfo* debug = nullptr);
+		/// <summary>
+		/// Support point of minkowski difference A - B.
+		/// Hints are polygon vertex indices of a nearby earlier support, e.g. from the current simplex.
+		/// </summary>
 		static SimplexVertex support(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Vector2& direction);
-		static std::pair<Vector2, Index> findFurthestPoint(const ShapePrimitive& shape, const Vector2& direction);
+			const Vector2& direction, const Index& hintA = UINT32_MAX, const Index& hintB = UINT32_MAX);
+		static std::pair<Vector2, Index> findFurthestPoint(const ShapePrimitive& shape, const Vector2& direction,
+			const Index& hint = UINT32_MAX);
 		static Vector2 findDirectionByEdge(const SimplexVertex& v1, const SimplexVertex& v2, bool pointToOrigin);
+		/// <summary>
+		/// Scan all vertices, four per SSE iteration. The first vertex of equal maxima wins.
+		/// </summary>
 		static std::pair<Vector2, Index> findFurthestPoint(const std::vector<Vector2>& vertices,
 			const Vector2& direction);
+		/// <summary>
+		/// Polygons with more than HillClimbingThreshold vertices walk from hint to the neighbor that increases the
+		/// projection until none does, smaller ones or an invalid hint use the full scan.
+		/// Vertices must be convex and in winding order.
+		/// </summary>
+		static std::pair<Vector2, Index> findFurthestPoint(const std::vector<Vector2>& vertices,
+			const Vector2& direction, const Index& hint);
+
+		static constexpr size_t HillClimbingThreshold = 32;
+		/// <summary>
+		/// Clip features of the closest edge in info.simplex into contacts.
+		/// Info comes from epa, or from gjkDistance for speculative contacts: then normal still points from B to A
+		/// and penetration is the negative distance.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="info"></param>
+		/// <param name="margin">incident points separated from reference edge up to margin are kept</param>
+		/// <returns></returns>
 		static ContactPair generateContacts(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			CollisionInfo& info);
+			CollisionInfo& info, const real& margin = 0);
 
 		static CollisionInfo gjkDistance(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const size_t& iteration = 10);
+			const size_t& iteration = 10, CollisionDebugInfo* debug = nullptr);
+
+		/// <summary>
+		/// First time that two moving shapes get closer than tolerance, found by conservative advancement:
+		/// each step measures the distance by gjkDistance and advances as far as the motion bound allows,
+		/// so the shapes never pass through each other between steps.
+		/// Transforms of shapeA and shapeB are ignored, positions come from sweeps.
+		/// If iterations run out, the last safe time is reported as a hit.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="sweepA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="sweepB"></param>
+		/// <param name="tolerance">target separation at time of impact</param>
+		/// <param name="iteration"></param>
+		/// <returns></returns>
+		static TimeOfImpact timeOfImpact(const ShapePrimitive& shapeA, const Sweep& sweepA,
+			const ShapePrimitive& shapeB, const Sweep& sweepB, const real& tolerance = Constant::LinearSlop,
+			const size_t& iteration = Constant::CCDMaxIterations);
+
+		/// <summary>
+		/// Cast shapeA along translationA against static shapeB by gjk raycast, see
+		/// "Ray Casting against General Convex Objects with Application to Continuous Collision Detection", Gino van den
+		/// Bergen. The ray from origin is cast against A - B, support points come from the same support() as gjk.
+		/// Shapes that overlap at the start are reported as a hit at fraction 0.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="translationA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="tolerance">shapes stop within this distance before contact</param>
+		/// <param name="iteration"></param>
+		/// <returns></returns>
+		static ShapeCast shapeCast(const ShapePrimitive& shapeA, const Vector2& translationA,
+			const ShapePrimitive& shapeB, const real& tolerance = Constant::LinearSlop,
+			const size_t& iteration = Constant::CCDMaxIterations);
+
+		/// <summary>
+		/// Full collision test. Pairs of polygon, capsule, edge and circle are solved by analytic routines picked from a
+		/// type-pair table, other pairs fall back to gjk, epa and generateContacts.
+		/// Output follows the same convention as generateContacts: normal points from B to A and
+		/// pointB - pointA = normal * penetration. info.simplex is only filled by the fallback.\n
+		/// With a positive margin, separated shapes closer than margin also get speculative contacts with negative
+		/// penetration, so that a solver can stop them before they touch instead of running CCD.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="info">normal and penetration of the deepest contact</param>
+		/// <param name="contacts"></param>
+		/// <param name="cache">optional gjk warm start cache of this pair, only used by the fallback</param>
+		/// <param name="margin">speculative distance, 0 generates contacts of overlapping shapes only</param>
+		/// <returns>true if contacts are generated</returns>
+		static bool collide(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, CollisionInfo& info,
+			ContactPair& contacts, SimplexCache* cache = nullptr, const real& margin = 0);
+		/// <summary>
+		/// Run collide over every pair on ThreadPool. Buffer is resized to pairs.size() and every slot is written.
+		/// </summary>
+		/// <param name="pairs">e.g. broadphase output</param>
+		/// <param name="buffer"></param>
+		/// <param name="margin">speculative distance of collide</param>
+		static void collideBatch(std::span<const ShapePair> pairs, ContactBuffer& buffer, const real& margin = 0);
+		/// <summary>
+		/// Distance query that gives up as soon as the shapes are proven farther than maxDistance.
+		/// Gjk keeps the closest point v of the simplex as upper bound, and the support plane against -v as lower
+		/// bound. It stops once the lower bound exceeds maxDistance or both bounds meet.
+		/// </summary>
+		/// <param name="shapeA"></param>
+		/// <param name="shapeB"></param>
+		/// <param name="maxDistance"></param>
+		/// <param name="result">filled only if true is returned</param>
+		/// <param name="iteration"></param>
+		/// <returns>true if distance is not greater than maxDistance</returns>
+		static bool distance(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const real& maxDistance,
+			DistanceResult& result, const size_t& iteration = 20);
+		/// <summary>
+		/// Run distance over every pair on ThreadPool.
+		/// </summary>
+		/// <param name="pairs"></param>
+		/// <param name="maxDistance"></param>
+		/// <returns>pairs within maxDistance, in order of pairs</returns>
+		static std::vector<DistanceResult> distanceBatch(std::span<const ShapePair> pairs, const real& maxDistance);
+		/// <summary>
+		/// Yes or no test for sensors and triggers. Circles, polygons, capsules and edges are decided by analytic tests
+		/// that exit on the first separating axis, other pairs use overlapGeneric.
+		/// </summary>
+		static bool overlap(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+		/// <summary>
+		/// Lean gjk of overlap. Only minkowski points are kept, no indices, no perturbation and no result simplex.
+		/// Stops on the first support point that does not pass origin.
+		/// </summary>
+		static bool overlapGeneric(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			const size_t& iteration = 30);
+		/// <summary>
+		/// Generic path of collide, usable for any pair of shapes.
+		/// Separated pairs are filtered by distance first, only pairs within margin run gjkDistance for features.
+		/// </summary>
+		static bool collideGeneric(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, CollisionInfo& info,
+			ContactPair& contacts, SimplexCache* cache = nullptr, const real& margin = 0);
 
 	private:
+		static void initializeSimplex(Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+		static Simplex gjkIterate(Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			const size_t& iteration);
+		static bool restoreSimplex(const SimplexCache& cache, const ShapePrimitive& shapeA,
+			const ShapePrimitive& shapeB, Simplex& simplex);
+		static void storeSimplex(const Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			SimplexCache& cache);
+
 		static void reconstructSimplexByVoronoi(Simplex& simplex);
 
 		static bool perturbSimplex(Simplex& simplex, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
@@ -108,27 +343,27 @@ namespace ST
 			const Index& AorB);
 
 		static ContactPair clipTwoEdge(const Vector2& va1, const Vector2& va2, const Vector2& vb1, const Vector2& vb2,
-			CollisionInfo& info);
+			CollisionInfo& info, const real& margin);
 
-		static ContactPair clipIncidentEdge(std::array<ClipVertex, 2>& incEdge, std::array<Vector2, 2> refEdge,
-			const Vector2& normal, bool swap);
+		static ContactPair clipIncidentEdge(std::array<ClipVertex, 2>& incEdge, const std::array<Vector2, 2>& refEdge,
+			const Vector2& normal, bool swap, const real& margin);
 
 		static ContactPair clipPolygonPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
+			const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin);
 		static ContactPair clipPolygonEdge(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
+			const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin);
 		static ContactPair clipPolygonCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
+			const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin);
 		static ContactPair clipPolygonRound(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
 			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
 
 		static ContactPair clipEdgeCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
+			const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin);
 		static ContactPair clipEdgeRound(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
 			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
 
 		static ContactPair clipCapsuleCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
-			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
+			const Feature& featureA, const Feature& featureB, CollisionInfo& info, const real& margin);
 		static ContactPair clipCapsuleRound(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
 			const Feature& featureA, const Feature& featureB, CollisionInfo& info);
 
@@ -138,12 +373,10 @@ namespace ST
 		static ContactPair clipEdgeVertex(const Vector2& va1, const Vector2& va2, const Vector2& vb,
 			CollisionInfo& info);
 
-		static void polytopeIterNext(std::list<SimplexVertexWithOriginDistance>::iterator& targetIter,
-			std::list<SimplexVertexWithOriginDistance>& list);
-		static void polytopeIterPrev(std::list<SimplexVertexWithOriginDistance>::iterator& targetIter,
-			std::list<SimplexVertexWithOriginDistance>& list);
+		//world position of polygon vertex, read from cache if it is valid
+		static Vector2 polygonVertex(const ShapePrimitive& shape, const Index& index);
 
-		static void buildPolytopeFromSimplex(std::list<SimplexVertexWithOriginDistance>& polytope,
-			const Simplex& simplex);
+		//feature of shape that point lies on, in the encoding of ContactPair::pointIds
+		static Index pointFeature(const ShapePrimitive& shape, const Feature& feature, const Vector2& point);
 	};
 }
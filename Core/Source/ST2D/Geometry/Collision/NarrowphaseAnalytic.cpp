@@ -0,0 +1,630 @@
+#include "Narrowphase.h"
+
+#include "ST2D/Geometry/Shape/Capsule.h"
+#include "ST2D/Geometry/Shape/Polygon.h"
+#include "ST2D/Geometry/Shape/Circle.h"
+#include "ST2D/Geometry/Shape/Edge.h"
+#include "ST2D/Geometry/Shape/ShapeCache.h"
+
+namespace ST
+{
+	//Closed form routines of Narrowphase::collide.
+	//Polygon, capsule and edge are all treated as a convex core with radius: polygon has radius 0,
+	//capsule is a segment with radius and edge is a segment with radius 0.
+	//Then one SAT + clipping routine covers all of them, refer box2d b2CollidePolygons.
+	//Features separated by less than margin still give contacts with negative penetration, i.e. speculative contacts.
+
+	enum class CollideResult
+	{
+		Separated,
+		Overlapping,
+		//routine can not handle this input, use generic path
+		Unsupported
+	};
+
+	using CollideFunction = CollideResult(*)(const ShapePrimitive&, const ShapePrimitive&, CollisionInfo&, ContactPair&,
+		const real&);
+
+	//polygon without cache is transformed into stack buffer, larger polygon goes to generic path
+	static constexpr size_t RoundedPolygonCapacity = 16;
+
+	struct RoundedPolygon
+	{
+		//world vertices and outward normal of edge (vertices[i], vertices[i + 1])
+		const Vector2* vertices = nullptr;
+		const Vector2* normals = nullptr;
+		Index count = 0;
+		real radius = 0;
+		std::array<Vector2, RoundedPolygonCapacity> vertexBuffer;
+		std::array<Vector2, RoundedPolygonCapacity> normalBuffer;
+	};
+
+	static bool makeSegment(const ShapePrimitive& shape, const Vector2& localStart, const Vector2& localEnd,
+		const Vector2& localNormal, real radius, RoundedPolygon& result)
+	{
+		result.vertexBuffer[0] = shape.transform.translatePoint(localStart);
+		result.vertexBuffer[1] = shape.transform.translatePoint(localEnd);
+		//normal from rotation, stays valid when segment degenerates to a point
+		result.normalBuffer[0] = Matrix2x2(shape.transform.rotation).multiply(localNormal);
+		result.normalBuffer[1] = result.normalBuffer[0].negative();
+		result.vertices = result.vertexBuffer.data();
+		result.normals = result.normalBuffer.data();
+		result.count = 2;
+		result.radius = radius;
+		return true;
+	}
+
+	static bool makeRoundedPolygon(const ShapePrimitive& shape, RoundedPolygon& result)
+	{
+		switch (shape.shape->type())
+		{
+		case ShapeType::Polygon:
+		{
+			if (const ShapeCache* cache = shape.validCache())
+			{
+				result.vertices = cache->vertices.data();
+				result.normals = cache->normals.data();
+				result.count = static_cast<Index>(cache->vertices.size());
+				return true;
+			}
+
+			const std::vector<Vector2>& vertices = static_cast<const Polygon*>(shape.shape)->vertices();
+			if (vertices.size() > RoundedPolygonCapacity)
+				return false;
+
+			const Index count = static_cast<Index>(vertices.size());
+			for (Index i = 0; i < count; ++i)
+				result.vertexBuffer[i] = shape.transform.translatePoint(vertices[i]);
+
+			//vertices are centered at centroid, orient normals away from transform position
+			for (Index i = 0; i < count; ++i)
+			{
+				Vector2 normal = (result.vertexBuffer[(i + 1) % count] - result.vertexBuffer[i]).perpendicular().normal();
+				if (normal.dot(result.vertexBuffer[i] - shape.transform.position) < 0)
+					normal.negate();
+				result.normalBuffer[i] = normal;
+			}
+			result.vertices = result.vertexBuffer.data();
+			result.normals = result.normalBuffer.data();
+			result.count = count;
+			return true;
+		}
+		case ShapeType::Capsule:
+		{
+			const Capsule* capsule = static_cast<const Capsule*>(shape.shape);
+			const real halfWidth = capsule->halfWidth();
+			const real halfHeight = capsule->halfHeight();
+			if (halfWidth >= halfHeight)
+				return makeSegment(shape, { halfWidth - halfHeight, 0 }, { halfHeight - halfWidth, 0 }, { 0, 1 },
+					halfHeight, result);
+			return makeSegment(shape, { 0, halfHeight - halfWidth }, { 0, halfWidth - halfHeight }, { 1, 0 },
+				halfWidth, result);
+		}
+		case ShapeType::Edge:
+		{
+			const Edge* edge = static_cast<const Edge*>(shape.shape);
+			const Vector2 localNormal = (edge->endPoint() - edge->startPoint()).perpendicular().normal();
+			return makeSegment(shape, edge->startPoint(), edge->endPoint(), localNormal, 0, result);
+		}
+		default:
+			return false;
+		}
+	}
+
+	//maximum over edges of polygon of minimum separation of vertices of other polygon
+	static real findMaxSeparation(const RoundedPolygon& polygon, const RoundedPolygon& other, Index& edgeIndex)
+	{
+		real maxSeparation = Constant::NegativeMin;
+		for (Index i = 0; i < polygon.count; ++i)
+		{
+			const Vector2& normal = polygon.normals[i];
+			const Vector2& vertex = polygon.vertices[i];
+			real minSeparation = Constant::Max;
+			for (Index j = 0; j < other.count; ++j)
+				minSeparation = Math::min(minSeparation, normal.dot(other.vertices[j] - vertex));
+
+			if (minSeparation > maxSeparation)
+			{
+				maxSeparation = minSeparation;
+				edgeIndex = i;
+			}
+		}
+		return maxSeparation;
+	}
+
+	//closest points of segment p1q1 and segment p2q2, refer Real-Time Collision Detection 5.1.9
+	static void closestPointsOfSegments(const Vector2& p1, const Vector2& q1, const Vector2& p2, const Vector2& q2,
+		real& s, real& t, Vector2& c1, Vector2& c2)
+	{
+		const Vector2 d1 = q1 - p1;
+		const Vector2 d2 = q2 - p2;
+		const Vector2 r = p1 - p2;
+		const real a = d1.dot(d1);
+		const real e = d2.dot(d2);
+		const real f = d2.dot(r);
+		s = 0;
+		t = 0;
+		if (a <= Constant::GeometryEpsilon && e <= Constant::GeometryEpsilon)
+		{
+		}
+		else if (a <= Constant::GeometryEpsilon)
+			t = Math::clamp(f / e, 0, 1);
+		else
+		{
+			const real c = d1.dot(r);
+			if (e <= Constant::GeometryEpsilon)
+				s = Math::clamp(-c / a, 0, 1);
+			else
+			{
+				const real b = d1.dot(d2);
+				const real denominator = a * e - b * b;
+				if (denominator != 0)
+					s = Math::clamp((b * f - c * e) / denominator, 0, 1);
+				t = (b * s + f) / e;
+				if (t < 0)
+				{
+					t = 0;
+					s = Math::clamp(-c / a, 0, 1);
+				}
+				else if (t > 1)
+				{
+					t = 1;
+					s = Math::clamp((b - c) / a, 0, 1);
+				}
+			}
+		}
+		c1 = p1 + d1 * s;
+		c2 = p2 + d2 * t;
+	}
+
+	//contact between two round features, centerA and centerB are the closest points of both cores
+	static CollideResult roundContact(const Vector2& centerA, real radiusA, const Vector2& centerB, real radiusB,
+		const Vector2& fallbackNormal, const uint64_t& pointId, const real& margin, CollisionInfo& info,
+		ContactPair& contacts)
+	{
+		const Vector2 d = centerB - centerA;
+		const real radius = radiusA + radiusB;
+		const real distanceSquare = d.lengthSquare();
+		if (distanceSquare > (radius + margin) * (radius + margin))
+			return CollideResult::Separated;
+
+		const real distance = std::sqrt(distanceSquare);
+		//normal from A to B
+		const Vector2 normal = distance > Constant::GeometryEpsilon ? d / distance : fallbackNormal;
+		info.normal = normal.negative();
+		info.penetration = radius - distance;
+		contacts.addContact(centerA + normal * radiusA, centerB - normal * radiusB, pointId);
+		return CollideResult::Overlapping;
+	}
+
+	static CollideResult collideCircles(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		CollisionInfo& info, ContactPair& contacts, const real& margin)
+	{
+		const real radiusA = static_cast<const Circle*>(shapeA.shape)->radius();
+		const real radiusB = static_cast<const Circle*>(shapeB.shape)->radius();
+		contacts.ids = { ContactPair::makeFeatureId(UINT32_MAX, UINT32_MAX), ContactPair::makeFeatureId(UINT32_MAX, UINT32_MAX) };
+		return roundContact(shapeA.transform.position, radiusA, shapeB.transform.position, radiusB, { 0, 1 },
+			ContactPair::makeFeatureId(UINT32_MAX, UINT32_MAX), margin, info, contacts);
+	}
+
+	static CollideResult collideRoundedCircle(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		CollisionInfo& info, ContactPair& contacts, const real& margin)
+	{
+		RoundedPolygon polygon;
+		if (!makeRoundedPolygon(shapeA, polygon))
+			return CollideResult::Unsupported;
+
+		const Vector2& center = shapeB.transform.position;
+		const real radiusB = static_cast<const Circle*>(shapeB.shape)->radius();
+		const real radius = polygon.radius + radiusB;
+
+		//face of max separation
+		real separation = Constant::NegativeMin;
+		Index edge = 0;
+		for (Index i = 0; i < polygon.count; ++i)
+		{
+			const real s = polygon.normals[i].dot(center - polygon.vertices[i]);
+			if (s > radius + margin)
+				return CollideResult::Separated;
+			if (s > separation)
+			{
+				separation = s;
+				edge = i;
+			}
+		}
+
+		const Index next = (edge + 1) % polygon.count;
+		contacts.ids = { ContactPair::makeFeatureId(edge, next), ContactPair::makeFeatureId(UINT32_MAX, UINT32_MAX) };
+
+		const Vector2& normal = polygon.normals[edge];
+		//segment core has only the normals of its sides, a center on its line beyond an end also has separation 0
+		if (polygon.count > 2 && separation <= 0)
+		{
+			//center is inside core, push out along face normal
+			info.normal = normal.negative();
+			info.penetration = radius - separation;
+			contacts.addContact(center - normal * (separation - polygon.radius), center - normal * radiusB,
+				ContactPair::makeFeatureId(edge, UINT32_MAX));
+			return CollideResult::Overlapping;
+		}
+
+		//closest point on face, covers vertex regions of both ends
+		const Vector2 closest = GeometryAlgorithm2D::pointToLineSegment(polygon.vertices[edge], polygon.vertices[next],
+			center);
+		Index feature = edge;
+		if (closest == polygon.vertices[edge])
+			feature = edge | ContactPair::VertexFeature;
+		else if (closest == polygon.vertices[next])
+			feature = next | ContactPair::VertexFeature;
+		return roundContact(closest, polygon.radius, center, radiusB, normal,
+			ContactPair::makeFeatureId(feature, UINT32_MAX), margin, info, contacts);
+	}
+
+	static CollideResult collideRoundedPolygons(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		CollisionInfo& info, ContactPair& contacts, const real& margin)
+	{
+		RoundedPolygon polygonA;
+		RoundedPolygon polygonB;
+		if (!makeRoundedPolygon(shapeA, polygonA) || !makeRoundedPolygon(shapeB, polygonB))
+			return CollideResult::Unsupported;
+
+		const real radius = polygonA.radius + polygonB.radius;
+		const real reach = radius + margin;
+
+		Index edgeA = 0;
+		const real separationA = findMaxSeparation(polygonA, polygonB, edgeA);
+		if (separationA > reach)
+			return CollideResult::Separated;
+
+		Index edgeB = 0;
+		const real separationB = findMaxSeparation(polygonB, polygonA, edgeB);
+		if (separationB > reach)
+			return CollideResult::Separated;
+
+		//prefer A as reference unless B is clearly better, keeps the choice stable between frames
+		const bool flip = separationB > separationA + real(0.1) * Constant::LinearSlop;
+		const RoundedPolygon& reference = flip ? polygonB : polygonA;
+		const RoundedPolygon& incident = flip ? polygonA : polygonB;
+		const Index i11 = flip ? edgeB : edgeA;
+		const Index i12 = (i11 + 1) % reference.count;
+		const Vector2 normal = reference.normals[i11];
+
+		//incident edge is the most anti-parallel one
+		Index i21 = 0;
+		real minDot = Constant::Max;
+		for (Index i = 0; i < incident.count; ++i)
+		{
+			const real dot = normal.dot(incident.normals[i]);
+			if (dot < minDot)
+			{
+				minDot = dot;
+				i21 = i;
+			}
+		}
+		const Index i22 = (i21 + 1) % incident.count;
+
+		const Vector2& v11 = reference.vertices[i11];
+		const Vector2& v12 = reference.vertices[i12];
+		const Vector2& v21 = incident.vertices[i21];
+		const Vector2& v22 = incident.vertices[i22];
+
+		//write contact and its point id given on reference and incident side, in the convention of generateContacts
+		auto addContact = [&](const Vector2& referencePoint, const Vector2& incidentPoint, const Index& referenceFeature,
+			const Index& incidentFeature)
+			{
+				if (flip)
+					contacts.addContact(incidentPoint, referencePoint,
+						ContactPair::makeFeatureId(incidentFeature, referenceFeature));
+				else
+					contacts.addContact(referencePoint, incidentPoint,
+						ContactPair::makeFeatureId(referenceFeature, incidentFeature));
+			};
+		auto setIds = [&](uint64_t referenceId, uint64_t incidentId)
+			{
+				contacts.ids = flip ? std::array<uint64_t, 2>{ incidentId, referenceId } : std::array<uint64_t, 2>{ referenceId, incidentId };
+			};
+
+		const real separation = Math::max(separationA, separationB);
+		//normals of two segments miss the axis along them when they are collinear, closest points decide instead
+		const bool isSegments = polygonA.count == 2 && polygonB.count == 2;
+		if (isSegments || separation > real(0.1) * Constant::LinearSlop)
+		{
+			//cores are apart, only radius makes them touch. Vertex to vertex case needs round normal.
+			real s = 0;
+			real t = 0;
+			Vector2 c1, c2;
+			closestPointsOfSegments(v11, v12, v21, v22, s, t, c1, c2);
+			const Vector2 d = c2 - c1;
+			const real distanceSquare = d.lengthSquare();
+			//closest points of reference and incident edge are the closest points of the cores only for segments
+			if (isSegments && distanceSquare > reach * reach)
+				return CollideResult::Separated;
+
+			const bool isVertex1 = s == 0 || s == 1;
+			const bool isVertex2 = t == 0 || t == 1;
+			if (isVertex1 && isVertex2)
+			{
+				if (distanceSquare > reach * reach)
+					return CollideResult::Separated;
+
+				const real distance = std::sqrt(distanceSquare);
+				const Vector2 roundNormal = distance > Constant::GeometryEpsilon ? d / distance : normal;
+				//normal from B to A
+				info.normal = flip ? roundNormal : roundNormal.negative();
+				info.penetration = radius - distance;
+				addContact(c1 + roundNormal * reference.radius, c2 - roundNormal * incident.radius,
+					(s == 0 ? i11 : i12) | ContactPair::VertexFeature, (t == 0 ? i21 : i22) | ContactPair::VertexFeature);
+				setIds(ContactPair::makeFeatureId(s == 0 ? i11 : i12, UINT32_MAX),
+					ContactPair::makeFeatureId(t == 0 ? i21 : i22, UINT32_MAX));
+				return CollideResult::Overlapping;
+			}
+		}
+
+		//clip incident edge by side planes of reference edge
+		const Vector2 tangent = (v12 - v11).normal();
+		const real upper1 = tangent.dot(v12 - v11);
+
+		Vector2 lowerPoint = v21;
+		Vector2 upperPoint = v22;
+		real lower2 = tangent.dot(v21 - v11);
+		real upper2 = tangent.dot(v22 - v11);
+		//winding of polygons is not assumed, sort incident vertices along tangent
+		Index lowerIndex = i21;
+		Index upperIndex = i22;
+		if (lower2 > upper2)
+		{
+			std::swap(lowerPoint, upperPoint);
+			std::swap(lower2, upper2);
+			std::swap(lowerIndex, upperIndex);
+		}
+		const Vector2 incidentEdge = upperPoint - lowerPoint;
+		const real span = upper2 - lower2;
+		Vector2 clipped[2] = { lowerPoint, upperPoint };
+		//unclipped point is an incident vertex on reference edge, clipped one is a reference vertex on incident edge
+		Index referenceFeatures[2] = { i11, i11 };
+		Index incidentFeatures[2] = { lowerIndex | ContactPair::VertexFeature, upperIndex | ContactPair::VertexFeature };
+		if (span > Constant::GeometryEpsilon)
+		{
+			if (lower2 < 0)
+			{
+				clipped[0] = lowerPoint + incidentEdge * Math::clamp(-lower2 / span, 0, 1);
+				referenceFeatures[0] = i11 | ContactPair::VertexFeature;
+				incidentFeatures[0] = i21;
+			}
+			if (upper2 > upper1)
+			{
+				clipped[1] = lowerPoint + incidentEdge * Math::clamp((upper1 - lower2) / span, 0, 1);
+				referenceFeatures[1] = i12 | ContactPair::VertexFeature;
+				incidentFeatures[1] = i21;
+			}
+		}
+		const size_t clippedCount = (clipped[1] - clipped[0]).lengthSquare() > Constant::GeometryEpsilon ? 2 : 1;
+
+		real maxPenetration = Constant::NegativeMin;
+		for (size_t i = 0; i < clippedCount; ++i)
+		{
+			const real s = normal.dot(clipped[i] - v11);
+			if (s > reach)
+				continue;
+
+			//project onto reference face and incident surface
+			addContact(clipped[i] - normal * (s - reference.radius), clipped[i] - normal * incident.radius,
+				referenceFeatures[i], incidentFeatures[i]);
+			maxPenetration = Math::max(maxPenetration, radius - s);
+		}
+
+		if (contacts.count == 0)
+			return CollideResult::Separated;
+
+		info.normal = flip ? normal : normal.negative();
+		info.penetration = maxPenetration;
+		setIds(ContactPair::makeFeatureId(i11, i12), ContactPair::makeFeatureId(i21, i22));
+		return CollideResult::Overlapping;
+	}
+
+	template <CollideFunction Function>
+	static CollideResult collideSwapped(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+		CollisionInfo& info, ContactPair& contacts, const real& margin)
+	{
+		const CollideResult result = Function(shapeB, shapeA, info, contacts, margin);
+		if (result != CollideResult::Overlapping)
+			return result;
+
+		info.normal.negate();
+		std::swap(contacts.points[0], contacts.points[1]);
+		std::swap(contacts.points[2], contacts.points[3]);
+		std::swap(contacts.ids[0], contacts.ids[1]);
+		for (uint64_t& id : contacts.pointIds)
+			id = ContactPair::swapFeatureId(id);
+		return result;
+	}
+
+	//[typeA][typeB] in order of ShapeType, nullptr means generic path
+	static constexpr CollideFunction CollideTable[5][5] = {
+		//Polygon
+		{ collideRoundedPolygons, collideRoundedPolygons, collideRoundedPolygons, collideRoundedCircle, nullptr },
+		//Edge, generic path has no clipping routine of edge and edge
+		{ collideRoundedPolygons, collideRoundedPolygons, collideRoundedPolygons, collideRoundedCircle, nullptr },
+		//Capsule
+		{ collideRoundedPolygons, collideRoundedPolygons, collideRoundedPolygons, collideRoundedCircle, nullptr },
+		//Circle
+		{ collideSwapped<collideRoundedCircle>, collideSwapped<collideRoundedCircle>, collideSwapped<collideRoundedCircle>, collideCircles, nullptr },
+		//Ellipse
+		{ nullptr, nullptr, nullptr, nullptr, nullptr }
+	};
+
+	//Boolean routines of Narrowphase::overlap, same shape model as above but no contact is generated.
+	//Unsupported means the answer can not be decided cheaply, then lean gjk takes over.
+
+	using OverlapFunction = CollideResult(*)(const ShapePrimitive&, const ShapePrimitive&);
+
+	static CollideResult overlapCircles(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		const real radius = static_cast<const Circle*>(shapeA.shape)->radius()
+			+ static_cast<const Circle*>(shapeB.shape)->radius();
+		const real distanceSquare = (shapeB.transform.position - shapeA.transform.position).lengthSquare();
+		return distanceSquare <= radius * radius ? CollideResult::Overlapping : CollideResult::Separated;
+	}
+
+	static CollideResult overlapRoundedCircle(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		RoundedPolygon polygon;
+		if (!makeRoundedPolygon(shapeA, polygon))
+			return CollideResult::Unsupported;
+
+		const Vector2& center = shapeB.transform.position;
+		const real radius = polygon.radius + static_cast<const Circle*>(shapeB.shape)->radius();
+
+		real separation = Constant::NegativeMin;
+		Index edge = 0;
+		for (Index i = 0; i < polygon.count; ++i)
+		{
+			const real s = polygon.normals[i].dot(center - polygon.vertices[i]);
+			if (s > radius)
+				return CollideResult::Separated;
+			if (s > separation)
+			{
+				separation = s;
+				edge = i;
+			}
+		}
+		//same as collideRoundedCircle, only polygon core contains the center when no side separates it
+		if (polygon.count > 2 && separation <= 0)
+			return CollideResult::Overlapping;
+
+		const Vector2 closest = GeometryAlgorithm2D::pointToLineSegment(polygon.vertices[edge],
+			polygon.vertices[(edge + 1) % polygon.count], center);
+		return (center - closest).lengthSquare() <= radius * radius
+			? CollideResult::Overlapping : CollideResult::Separated;
+	}
+
+	//true if some edge of polygon separates other by more than radius, otherwise maxSeparation is the largest one
+	static bool findSeparatingAxis(const RoundedPolygon& polygon, const RoundedPolygon& other, const real& radius,
+		real& maxSeparation)
+	{
+		for (Index i = 0; i < polygon.count; ++i)
+		{
+			const Vector2& normal = polygon.normals[i];
+			const Vector2& vertex = polygon.vertices[i];
+			real minSeparation = Constant::Max;
+			for (Index j = 0; j < other.count; ++j)
+				minSeparation = Math::min(minSeparation, normal.dot(other.vertices[j] - vertex));
+
+			if (minSeparation > radius)
+				return true;
+			maxSeparation = Math::max(maxSeparation, minSeparation);
+		}
+		return false;
+	}
+
+	static CollideResult overlapRoundedPolygons(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		RoundedPolygon polygonA;
+		RoundedPolygon polygonB;
+		if (!makeRoundedPolygon(shapeA, polygonA) || !makeRoundedPolygon(shapeB, polygonB))
+			return CollideResult::Unsupported;
+
+		const real radius = polygonA.radius + polygonB.radius;
+		real maxSeparation = Constant::NegativeMin;
+		if (findSeparatingAxis(polygonA, polygonB, radius, maxSeparation)
+			|| findSeparatingAxis(polygonB, polygonA, radius, maxSeparation))
+			return CollideResult::Separated;
+
+		//normals of two segments miss the axis along them when they are collinear
+		if (polygonA.count == 2 && polygonB.count == 2)
+		{
+			real s, t;
+			Vector2 c1, c2;
+			closestPointsOfSegments(polygonA.vertices[0], polygonA.vertices[1], polygonB.vertices[0],
+				polygonB.vertices[1], s, t, c1, c2);
+			return (c2 - c1).lengthSquare() <= radius * radius ? CollideResult::Overlapping : CollideResult::Separated;
+		}
+
+		//no separating axis between cores, or cores overlap
+		if (radius == 0 || maxSeparation <= 0)
+			return CollideResult::Overlapping;
+
+		//rounded corner regions of polygon against capsule
+		return CollideResult::Unsupported;
+	}
+
+	template <OverlapFunction Function>
+	static CollideResult overlapSwapped(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		return Function(shapeB, shapeA);
+	}
+
+	//[typeA][typeB] in order of ShapeType, nullptr means lean gjk
+	static constexpr OverlapFunction OverlapTable[5][5] = {
+		//Polygon
+		{ overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedCircle, nullptr },
+		//Edge
+		{ overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedCircle, nullptr },
+		//Capsule
+		{ overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedPolygons, overlapRoundedCircle, nullptr },
+		//Circle
+		{ overlapSwapped<overlapRoundedCircle>, overlapSwapped<overlapRoundedCircle>, overlapSwapped<overlapRoundedCircle>, overlapCircles, nullptr },
+		//Ellipse
+		{ nullptr, nullptr, nullptr, nullptr, nullptr }
+	};
+
+	bool Narrowphase::collide(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, CollisionInfo& info,
+		ContactPair& contacts, SimplexCache* cache, const real& margin)
+	{
+		const auto typeA = static_cast<size_t>(shapeA.shape->type());
+		const auto typeB = static_cast<size_t>(shapeB.shape->type());
+		if (const CollideFunction function = CollideTable[typeA][typeB])
+		{
+			//routines append to contacts
+			contacts = ContactPair();
+			const CollideResult result = function(shapeA, shapeB, info, contacts, margin);
+			if (result != CollideResult::Unsupported)
+				return result == CollideResult::Overlapping;
+
+			contacts = ContactPair();
+		}
+		return collideGeneric(shapeA, shapeB, info, contacts, cache, margin);
+	}
+
+	bool Narrowphase::collideGeneric(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, CollisionInfo& info,
+		ContactPair& contacts, SimplexCache* cache, const real& margin)
+	{
+		const Simplex simplex = cache != nullptr ? gjk(shapeA, shapeB, *cache) : gjk(shapeA, shapeB);
+		if (simplex.isContainOrigin)
+		{
+			info = epa(simplex, shapeA, shapeB);
+			contacts = generateContacts(shapeA, shapeB, info, margin);
+			return true;
+		}
+		if (margin <= 0)
+			return false;
+
+		//most separated pairs are farther than margin, bounded query rejects them before the full gjkDistance.
+		//Touching pairs have no normal
+		DistanceResult bound;
+		if (!distance(shapeA, shapeB, margin, bound) || bound.distance <= Constant::GeometryEpsilon)
+			return false;
+
+		//closest edge of gjkDistance gives features like the one of epa.
+		//Normal and closest points come from the bounded query, it converges tighter on round shapes
+		info = gjkDistance(shapeA, shapeB);
+		info.pair = bound.pair;
+		info.normal = (bound.pair.pointA - bound.pair.pointB) / bound.distance;
+		info.penetration = -bound.distance;
+		contacts = generateContacts(shapeA, shapeB, info, margin);
+		return contacts.count > 0;
+	}
+
+	bool Narrowphase::overlap(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		const auto typeA = static_cast<size_t>(shapeA.shape->type());
+		const auto typeB = static_cast<size_t>(shapeB.shape->type());
+		if (const OverlapFunction function = OverlapTable[typeA][typeB])
+		{
+			const CollideResult result = function(shapeA, shapeB);
+			if (result != CollideResult::Unsupported)
+				return result == CollideResult::Overlapping;
+		}
+		return overlapGeneric(shapeA, shapeB);
+	}
+}
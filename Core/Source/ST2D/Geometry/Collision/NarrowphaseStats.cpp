@@ -0,0 +1,131 @@
+#include "NarrowphaseStats.h"
+
+namespace ST
+{
+	struct AtomicHistogram
+	{
+		std::array<std::atomic<uint64_t>, IterationHistogram::BucketCount> buckets{};
+		std::array<std::atomic<uint64_t>, IterationHistogram::ExitCount> exits{};
+		std::atomic<uint64_t> count = 0;
+		std::atomic<uint64_t> iterationSum = 0;
+		std::atomic<uint64_t> maxIteration = 0;
+	};
+
+	static constexpr size_t QueryCount = NarrowphaseStats::QueryCount;
+	static constexpr size_t ShapeTypeCount = NarrowphaseStats::ShapeTypeCount;
+
+	static std::atomic<bool> s_isEnabled = false;
+	static AtomicHistogram s_histograms[QueryCount][ShapeTypeCount][ShapeTypeCount];
+	static std::atomic<uint64_t> s_perturbations[ShapeTypeCount][ShapeTypeCount];
+
+	void IterationHistogram::merge(const IterationHistogram& other)
+	{
+		for (size_t i = 0; i < BucketCount; ++i)
+			buckets[i] += other.buckets[i];
+		for (size_t i = 0; i < ExitCount; ++i)
+			exits[i] += other.exits[i];
+		count += other.count;
+		iterationSum += other.iterationSum;
+		maxIteration = std::max(maxIteration, other.maxIteration);
+	}
+
+	IterationHistogram NarrowphaseStats::total(NarrowphaseQuery query) const
+	{
+		IterationHistogram result;
+		for (auto&& row : histograms[static_cast<size_t>(query)])
+			for (auto&& histogram : row)
+				result.merge(histogram);
+		return result;
+	}
+
+	void NarrowphaseProfiler::setEnabled(bool enabled)
+	{
+		s_isEnabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	bool NarrowphaseProfiler::isEnabled()
+	{
+		return s_isEnabled.load(std::memory_order_relaxed);
+	}
+
+	void NarrowphaseProfiler::record(NarrowphaseQuery query, const ShapePrimitive& shapeA,
+		const ShapePrimitive& shapeB, size_t iterations, QueryExit exit)
+	{
+		if (!isEnabled())
+			return;
+
+		AtomicHistogram& histogram = s_histograms[static_cast<size_t>(query)]
+			[static_cast<size_t>(shapeA.shape->type())][static_cast<size_t>(shapeB.shape->type())];
+
+		const size_t bucket = std::min(iterations, IterationHistogram::BucketCount - 1);
+		histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		histogram.exits[static_cast<size_t>(exit)].fetch_add(1, std::memory_order_relaxed);
+		histogram.count.fetch_add(1, std::memory_order_relaxed);
+		histogram.iterationSum.fetch_add(iterations, std::memory_order_relaxed);
+
+		uint64_t maxIteration = histogram.maxIteration.load(std::memory_order_relaxed);
+		while (iterations > maxIteration
+			&& !histogram.maxIteration.compare_exchange_weak(maxIteration, iterations, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void NarrowphaseProfiler::recordPerturbation(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	{
+		if (!isEnabled())
+			return;
+
+		s_perturbations[static_cast<size_t>(shapeA.shape->type())][static_cast<size_t>(shapeB.shape->type())]
+			.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	NarrowphaseStats NarrowphaseProfiler::snapshot()
+	{
+		NarrowphaseStats stats;
+		for (size_t query = 0; query < QueryCount; ++query)
+		{
+			for (size_t typeA = 0; typeA < ShapeTypeCount; ++typeA)
+			{
+				for (size_t typeB = 0; typeB < ShapeTypeCount; ++typeB)
+				{
+					const AtomicHistogram& source = s_histograms[query][typeA][typeB];
+					IterationHistogram& target = stats.histograms[query][typeA][typeB];
+					for (size_t i = 0; i < IterationHistogram::BucketCount; ++i)
+						target.buckets[i] = source.buckets[i].load(std::memory_order_relaxed);
+					for (size_t i = 0; i < IterationHistogram::ExitCount; ++i)
+						target.exits[i] = source.exits[i].load(std::memory_order_relaxed);
+					target.count = source.count.load(std::memory_order_relaxed);
+					target.iterationSum = source.iterationSum.load(std::memory_order_relaxed);
+					target.maxIteration = source.maxIteration.load(std::memory_order_relaxed);
+				}
+			}
+		}
+		for (size_t typeA = 0; typeA < ShapeTypeCount; ++typeA)
+			for (size_t typeB = 0; typeB < ShapeTypeCount; ++typeB)
+				stats.perturbations[typeA][typeB] = s_perturbations[typeA][typeB].load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void NarrowphaseProfiler::reset()
+	{
+		for (auto&& queries : s_histograms)
+		{
+			for (auto&& row : queries)
+			{
+				for (auto&& histogram : row)
+				{
+					for (auto&& bucket : histogram.buckets)
+						bucket.store(0, std::memory_order_relaxed);
+					for (auto&& exit : histogram.exits)
+						exit.store(0, std::memory_order_relaxed);
+					histogram.count.store(0, std::memory_order_relaxed);
+					histogram.iterationSum.store(0, std::memory_order_relaxed);
+					histogram.maxIteration.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+		for (auto&& row : s_perturbations)
+			for (auto&& counter : row)
+				counter.store(0, std::memory_order_relaxed);
+	}
+}
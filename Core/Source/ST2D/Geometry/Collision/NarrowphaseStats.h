@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ST2D/Geometry/Shape/Shape.h"
+
+//Recording expressions are compiled only if ST_ENABLE_NARROWPHASE_STATS is defined, debug build defines it in Core.h.
+#ifdef ST_ENABLE_NARROWPHASE_STATS
+#define ST_NARROWPHASE_STATS(...) __VA_ARGS__
+#else
+#define ST_NARROWPHASE_STATS(...) ((void)0)
+#endif
+
+namespace ST
+{
+	enum class NarrowphaseQuery
+	{
+		Gjk,
+		Epa,
+		GjkDistance
+	};
+
+	enum class QueryExit
+	{
+		//gjk encloses origin, epa and gjkDistance find no farther support
+		Converged,
+		//gjk stops on separating axis or repeated support
+		EarlyExit,
+		//polytope is full, or gjkDistance fails to rewind a non convex expansion
+		Degenerate,
+		IterationLimit
+	};
+
+	struct ST_API IterationHistogram
+	{
+		//last bucket also counts all larger iterations
+		static constexpr size_t BucketCount = 32;
+		static constexpr size_t ExitCount = 4;
+
+		std::array<uint64_t, BucketCount> buckets{};
+		std::array<uint64_t, ExitCount> exits{};
+		uint64_t count = 0;
+		uint64_t iterationSum = 0;
+		uint64_t maxIteration = 0;
+
+		real mean() const
+		{
+			return count == 0 ? 0 : static_cast<real>(iterationSum) / static_cast<real>(count);
+		}
+
+		uint64_t exitCount(QueryExit exit) const
+		{
+			return exits[static_cast<size_t>(exit)];
+		}
+
+		void merge(const IterationHistogram& other);
+	};
+
+	/**
+	 * \brief Copy of narrowphase counters, indexed by query and ShapeType of both shapes in the order they are passed.
+	 */
+	struct ST_API NarrowphaseStats
+	{
+		static constexpr size_t QueryCount = 3;
+		static constexpr size_t ShapeTypeCount = 5;
+
+		std::array<std::array<std::array<IterationHistogram, ShapeTypeCount>, ShapeTypeCount>, QueryCount> histograms;
+		//perturbSimplex calls of gjk
+		std::array<std::array<uint64_t, ShapeTypeCount>, ShapeTypeCount> perturbations{};
+
+		const IterationHistogram& histogram(NarrowphaseQuery query, ShapeType typeA, ShapeType typeB) const
+		{
+			return histograms[static_cast<size_t>(query)][static_cast<size_t>(typeA)][static_cast<size_t>(typeB)];
+		}
+
+		//merged over all shape pairs
+		IterationHistogram total(NarrowphaseQuery query) const;
+	};
+
+	/**
+	 * \brief Global convergence counters of gjk, epa and gjkDistance for tuning iteration limits.
+	 * Recording is a few relaxed atomic adds, so queries running on ThreadPool may record concurrently.
+	 * Off by default at runtime, and compiled out without ST_ENABLE_NARROWPHASE_STATS.
+	 */
+	class ST_API NarrowphaseProfiler
+	{
+	public:
+		static void setEnabled(bool enabled);
+		static bool isEnabled();
+
+		static void record(NarrowphaseQuery query, const ShapePrimitive& shapeA, const ShapePrimitive& shapeB,
+			size_t iterations, QueryExit exit);
+		static void recordPerturbation(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+
+		static NarrowphaseStats snapshot();
+		static void reset();
+	};
+}
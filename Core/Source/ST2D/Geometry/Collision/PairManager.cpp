@@ -0,0 +1,67 @@
+#include "PairManager.h"
+
+namespace ST
+{
+	void PairManager::update(const std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>>& pairs)
+	{
+		m_beginPairs.clear();
+		m_endPairs.clear();
+		++m_frame;
+
+		for (auto&& [bodyA, bodyB] : pairs)
+		{
+			const PairID id = mixPairUUID(bodyA->userData.uuid, bodyB->userData.uuid);
+			auto [pair, isNew] = m_table.emplace(id);
+			if (isNew)
+			{
+				pair->bodyA = bodyA;
+				pair->bodyB = bodyB;
+				pair->id = id;
+				m_beginPairs.emplace_back(*pair);
+			}
+			pair->frame = m_frame;
+		}
+
+		//pairs that are not reported in this frame stop overlapping
+		m_table.forEach([this](const PairID&, PersistentPair& pair)
+			{
+				if (pair.frame != m_frame)
+					m_endPairs.emplace_back(pair);
+			});
+
+		for (auto&& pair : m_endPairs)
+			m_table.erase(pair.id);
+	}
+
+	const std::vector<PersistentPair>& PairManager::beginPairs() const
+	{
+		return m_beginPairs;
+	}
+
+	const std::vector<PersistentPair>& PairManager::endPairs() const
+	{
+		return m_endPairs;
+	}
+
+	PersistentPair* PairManager::find(const PairID& id)
+	{
+		return m_table.find(id);
+	}
+
+	PersistentPair* PairManager::find(ShapePrimitive* bodyA, ShapePrimitive* bodyB)
+	{
+		return m_table.find(mixPairUUID(bodyA->userData.uuid, bodyB->userData.uuid));
+	}
+
+	size_t PairManager::size() const
+	{
+		return m_table.size();
+	}
+
+	void PairManager::clearAll()
+	{
+		m_table.clear();
+		m_beginPairs.clear();
+		m_endPairs.clear();
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PairTable.h"
+
+namespace ST
+{
+	/**
+	 * \brief Overlapping pair that survives across frames.
+	 */
+	struct ST_API PersistentPair
+	{
+		ShapePrimitive* bodyA = nullptr;
+		ShapePrimitive* bodyB = nullptr;
+		PairID id = 0;
+		//frame stamp of the last update that reported this pair
+		uint32_t frame = 0;
+		//user slot, e.g. cached narrowphase data. It is handed back in end events so that it can be released.
+		void* userData = nullptr;
+	};
+
+	/**
+	 * \brief Pair cache fed by broadphase output every frame.
+	 * Only changes are reported: pairs that begin overlapping and pairs that end overlapping.
+	 */
+	class ST_API PairManager
+	{
+	public:
+		/**
+		 * \brief Feed the overlapping pairs of current frame, then begin/end events are refreshed.
+		 * \param pairs
+		 */
+		void update(const std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>>& pairs);
+
+		const std::vector<PersistentPair>& beginPairs() const;
+		const std::vector<PersistentPair>& endPairs() const;
+
+		PersistentPair* find(const PairID& id);
+		PersistentPair* find(ShapePrimitive* bodyA, ShapePrimitive* bodyB);
+		size_t size() const;
+		void clearAll();
+
+		/**
+		 * \brief Visit every persistent pair as func(PersistentPair&).
+		 */
+		template<typename Func>
+		void forEach(Func&& func)
+		{
+			m_table.forEach([&func](const PairID&, PersistentPair& pair) { func(pair); });
+		}
+
+	private:
+		PairTable<PersistentPair> m_table;
+		std::vector<PersistentPair> m_beginPairs;
+		std::vector<PersistentPair> m_endPairs;
+		uint32_t m_frame = 0;
+	};
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "ST2D/Geometry/Shape/Shape.h"
+
+namespace ST
+{
+	/**
+	 * \brief Hash table keyed by PairID. Open addressing with linear probing and backward shift deletion,
+	 * all slots live in one contiguous array so lookup does not chase pointers like std::map.\n
+	 * Pointers returned by find/emplace are invalidated by the next emplace or erase.
+	 * \tparam T value type, must be default constructible
+	 */
+	template<typename T>
+	class PairTable
+	{
+	public:
+		PairTable() = default;
+
+		T* find(const PairID& id)
+		{
+			if (m_slots.empty())
+				return nullptr;
+			for (size_t i = hash(id) & mask();; i = (i + 1) & mask())
+			{
+				Slot& slot = m_slots[i];
+				if (!slot.isOccupied)
+					return nullptr;
+				if (slot.id == id)
+					return &slot.value;
+			}
+		}
+
+		const T* find(const PairID& id) const
+		{
+			return const_cast<PairTable*>(this)->find(id);
+		}
+
+		/**
+		 * \brief Find value by id, insert a default constructed one if not exists.
+		 * \param id
+		 * \return value and whether it is newly inserted
+		 */
+		std::pair<T*, bool> emplace(const PairID& id)
+		{
+			//keep load factor below 1/2
+			if ((m_count + 1) * 2 > m_slots.size())
+				rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+
+			for (size_t i = hash(id) & mask();; i = (i + 1) & mask())
+			{
+				Slot& slot = m_slots[i];
+				if (!slot.isOccupied)
+				{
+					slot.id = id;
+					slot.value = T{};
+					slot.isOccupied = true;
+					++m_count;
+					return { &slot.value, true };
+				}
+				if (slot.id == id)
+					return { &slot.value, false };
+			}
+		}
+
+		bool erase(const PairID& id)
+		{
+			if (m_slots.empty())
+				return false;
+
+			size_t hole = hash(id) & mask();
+			while (true)
+			{
+				if (!m_slots[hole].isOccupied)
+					return false;
+				if (m_slots[hole].id == id)
+					break;
+				hole = (hole + 1) & mask();
+			}
+
+			//shift following slots back, so that probing never meets a hole before its target
+			for (size_t next = (hole + 1) & mask(); m_slots[next].isOccupied; next = (next + 1) & mask())
+			{
+				const size_t home = hash(m_slots[next].id) & mask();
+				const bool isBetween = hole <= next ? hole < home && home <= next : hole < home || home <= next;
+				if (isBetween)
+					continue;
+				m_slots[hole] = std::move(m_slots[next]);
+				hole = next;
+			}
+			m_slots[hole].isOccupied = false;
+			m_slots[hole].value = T{};
+			--m_count;
+			return true;
+		}
+
+		void clear()
+		{
+			m_slots.clear();
+			m_count = 0;
+		}
+
+		size_t size() const
+		{
+			return m_count;
+		}
+
+		bool empty() const
+		{
+			return m_count == 0;
+		}
+
+		/**
+		 * \brief Visit every entry as func(const PairID&, T&). Do not emplace or erase inside func.
+		 */
+		template<typename Func>
+		void forEach(Func&& func)
+		{
+			for (auto&& slot : m_slots)
+				if (slot.isOccupied)
+					func(std::as_const(slot.id), slot.value);
+		}
+
+	private:
+		struct Slot
+		{
+			PairID id = 0;
+			T value{};
+			bool isOccupied = false;
+		};
+
+		size_t mask() const
+		{
+			return m_slots.size() - 1;
+		}
+
+		static size_t hash(PairID id)
+		{
+			//splitmix64 finalizer
+			id ^= id >> 30;
+			id *= 0xbf58476d1ce4e5b9ull;
+			id ^= id >> 27;
+			id *= 0x94d049bb133111ebull;
+			id ^= id >> 31;
+			return static_cast<size_t>(id);
+		}
+
+		void rehash(size_t capacity)
+		{
+			std::vector<Slot> old = std::move(m_slots);
+			m_slots.clear();
+			m_slots.resize(capacity);
+			m_count = 0;
+			for (auto&& slot : old)
+			{
+				if (!slot.isOccupied)
+					continue;
+				auto [value, isNew] = emplace(slot.id);
+				*value = std::move(slot.value);
+			}
+		}
+
+		std::vector<Slot> m_slots;
+		size_t m_count = 0;
+	};
+}
@@ -0,0 +1,161 @@
+#include "Polytope.h"
+namespace ST
+{
+	void Polytope::build(const Simplex& simplex)
+	{
+		clear();
+		m_count = static_cast<Index>(simplex.count);
+		for (Index i = 0; i < m_count; ++i)
+		{
+			m_vertices[i].vertex = simplex.vertices[i];
+			m_next[i] = (i + 1) % m_count;
+			m_prev[i] = (i + m_count - 1) % m_count;
+		}
+		for (Index i = 0; i < m_count; ++i)
+		{
+			//use lengthSquare() to avoid sqrt
+			setDistance(i, GeometryAlgorithm2D::pointToLineSegment(m_vertices[i].vertex.result,
+				m_vertices[m_next[i]].vertex.result, { 0, 0 }).lengthSquare());
+		}
+	}
+
+	void Polytope::clear()
+	{
+		m_count = 0;
+		m_heapSize = 0;
+		m_stamp = 0;
+	}
+
+	Index Polytope::insert(const Index& edge, const SimplexVertex& vertex)
+	{
+		if (isFull())
+			return UINT32_MAX;
+
+		const Index index = m_count++;
+		const Index end = m_next[edge];
+		m_vertices[index].vertex = vertex;
+		m_next[index] = end;
+		m_prev[index] = edge;
+		m_next[edge] = index;
+		m_prev[end] = index;
+
+		setDistance(edge, GeometryAlgorithm2D::pointToLineSegment(m_vertices[edge].vertex.result, vertex.result,
+			{ 0, 0 }).lengthSquare());
+		setDistance(index, GeometryAlgorithm2D::pointToLineSegment(vertex.result, m_vertices[end].vertex.result,
+			{ 0, 0 }).lengthSquare());
+		return index;
+	}
+
+	Index Polytope::closestEdge(const Index& start)
+	{
+		//pop entries whose edge has been split since they were pushed
+		while (m_heapSize > 0 && m_heap[0].stamp != m_stamps[m_heap[0].edge])
+		{
+			m_heap[0] = m_heap[--m_heapSize];
+			for (Index parent = 0;;)
+			{
+				const Index left = parent * 2 + 1;
+				const Index right = left + 1;
+				Index smallest = parent;
+				if (left < m_heapSize && less(m_heap[left], m_heap[smallest]))
+					smallest = left;
+				if (right < m_heapSize && less(m_heap[right], m_heap[smallest]))
+					smallest = right;
+				if (smallest == parent)
+					break;
+				std::swap(m_heap[parent], m_heap[smallest]);
+				parent = smallest;
+			}
+		}
+		assert(m_heapSize > 0);
+
+		//walking from start meets start first if it is in the tie run, otherwise the first edge of the run
+		const Index closest = m_heap[0].edge;
+		const real distance = m_vertices[closest].distance;
+		for (Index edge = closest, i = 0; i < m_count && m_vertices[edge].distance == distance; edge = m_next[edge], ++i)
+			if (edge == start)
+				return start;
+
+		Index edge = closest;
+		for (Index i = 1; i < m_count; ++i)
+		{
+			const Index previous = m_prev[edge];
+			if (m_vertices[previous].distance != distance)
+				break;
+			edge = previous;
+			if (edge == start)
+				break;
+		}
+		return edge;
+	}
+
+	Index Polytope::next(const Index& index) const
+	{
+		return m_next[index];
+	}
+
+	Index Polytope::prev(const Index& index) const
+	{
+		return m_prev[index];
+	}
+
+	const SimplexVertex& Polytope::vertex(const Index& index) const
+	{
+		return m_vertices[index].vertex;
+	}
+
+	real Polytope::distance(const Index& index) const
+	{
+		return m_vertices[index].distance;
+	}
+
+	size_t Polytope::size() const
+	{
+		return m_count;
+	}
+
+	bool Polytope::isFull() const
+	{
+		return m_count == Capacity;
+	}
+
+	void Polytope::exportTo(std::vector<SimplexVertexWithOriginDistance>& result) const
+	{
+		result.clear();
+		if (m_count == 0)
+			return;
+
+		result.reserve(m_count);
+		Index index = 0;
+		do
+		{
+			result.emplace_back(m_vertices[index]);
+			index = m_next[index];
+		} while (index != 0);
+	}
+
+	void Polytope::setDistance(const Index& edge, const real& distance)
+	{
+		m_vertices[edge].distance = distance;
+		m_stamps[edge] = ++m_stamp;
+
+		//sift up
+		Index child = m_heapSize++;
+		m_heap[child] = { distance, edge, m_stamp };
+		while (child > 0)
+		{
+			const Index parent = (child - 1) / 2;
+			if (!less(m_heap[child], m_heap[parent]))
+				break;
+			std::swap(m_heap[child], m_heap[parent]);
+			child = parent;
+		}
+	}
+
+	bool Polytope::less(const HeapEntry& lhs, const HeapEntry& rhs)
+	{
+		if (lhs.distance != rhs.distance)
+			return lhs.distance < rhs.distance;
+		return lhs.stamp < rhs.stamp;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Simplex.h"
+
+namespace ST
+{
+	struct ST_API SimplexVertexWithOriginDistance
+	{
+		SimplexVertex vertex;
+		real distance = 0;
+	};
+
+	/**
+	 * \brief Polytope expanded by epa. Vertices live in a fixed inline array and are linked by index in winding order,
+	 * so inserting a vertex never allocates.\n
+	 * Edge (i, next(i)) is keyed by vertex i and its squared distance to origin is stored in vertex i.
+	 * Closest edge is the top of a binary min-heap, entries of split edges are dropped lazily.
+	 */
+	class ST_API Polytope
+	{
+	public:
+		static constexpr Index Capacity = 64;
+
+		void build(const Simplex& simplex);
+		void clear();
+		/**
+		 * \brief Insert vertex between edge and next(edge), both new edges are pushed into heap.
+		 * \param edge
+		 * \param vertex
+		 * \return index of new vertex, UINT32_MAX if polytope is full
+		 */
+		Index insert(const Index& edge, const SimplexVertex& vertex);
+		/**
+		 * \brief Edge closest to origin. Among a run of adjacent edges with the same distance, e.g. two edges sharing
+		 * the closest vertex, the first one met walking from start in winding order is returned.
+		 * \param start usually the edge split last
+		 * \return
+		 */
+		Index closestEdge(const Index& start);
+
+		Index next(const Index& index) const;
+		Index prev(const Index& index) const;
+		const SimplexVertex& vertex(const Index& index) const;
+		real distance(const Index& index) const;
+		size_t size() const;
+		bool isFull() const;
+
+		/**
+		 * \brief Copy vertices in winding order, starting from the first vertex of the simplex.
+		 */
+		void exportTo(std::vector<SimplexVertexWithOriginDistance>& result) const;
+
+	private:
+		struct HeapEntry
+		{
+			real distance = 0;
+			Index edge = 0;
+			//stamp of edge when pushed, also breaks ties in favor of older entry
+			Index stamp = 0;
+		};
+
+		void setDistance(const Index& edge, const real& distance);
+		static bool less(const HeapEntry& lhs, const HeapEntry& rhs);
+
+		std::array<SimplexVertexWithOriginDistance, Capacity> m_vertices;
+		std::array<Index, Capacity> m_next{};
+		std::array<Index, Capacity> m_prev{};
+		std::array<Index, Capacity> m_stamps{};
+		Index m_count = 0;
+
+		//every insertion pushes two entries
+		std::array<HeapEntry, Capacity * 2> m_heap;
+		Index m_heapSize = 0;
+		Index m_stamp = 0;
+	};
+}
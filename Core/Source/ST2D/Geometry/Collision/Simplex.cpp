@@ -9,7 +9,7 @@ namespace ST
 
 	bool SimplexVertexArray::containOrigin(const SimplexVertexArray& simplex, bool strict)
 	{
-		switch (simplex.vertices.size())
+		switch (simplex.count)
 		{
 		case 4:
 		{
@@ -28,31 +28,74 @@ namespace ST
 		}
 	}
 
-	void SimplexVertexArray::insert(const size_t& pos, const SimplexVertex& vertex)
+	bool SimplexVertexArray::insert(const size_t& pos, const SimplexVertex& vertex)
+	{
+		const size_t target = pos + 1;
+		assert(target <= count);
+		if (isFull())
+			return false;
+
+		std::memmove(vertices.data() + target + 1, vertices.data() + target, (count - target) * sizeof(SimplexVertex));
+		vertices[target] = vertex;
+		++count;
+		return true;
+	}
+
+	bool SimplexVertexArray::addSimplexVertex(const SimplexVertex& vertex)
+	{
+		if (isFull())
+			return false;
+		vertices[count] = vertex;
+		++count;
+		return true;
+	}
+
+	void SimplexVertexArray::removeByIndex(const size_t& index)
+	{
+		assert(index < count);
+		std::memmove(vertices.data() + index, vertices.data() + index + 1, (count - index - 1) * sizeof(SimplexVertex));
+		--count;
+	}
+
+	void SimplexVertexArray::removeAll()
 	{
-		vertices.insert(vertices.begin() + pos + 1, vertex);
+		count = 0;
+		isContainOrigin = false;
 	}
 
-	bool SimplexVertexArray::contains(const SimplexVertex& vertex)
+	bool SimplexVertexArray::contains(const SimplexVertex& vertex) const
 	{
-		return std::find(std::begin(vertices), std::end(vertices), vertex) != std::end(vertices);
+		const auto end = vertices.begin() + count;
+		return std::find(vertices.begin(), end, vertex) != end;
 	}
 
-	bool SimplexVertexArray::fuzzyContains(const SimplexVertex& vertex, const real& epsilon)
+	bool SimplexVertexArray::fuzzyContains(const SimplexVertex& vertex, const real& epsilon) const
 	{
-		return std::find_if(std::begin(vertices), std::end(vertices),
+		const auto end = vertices.begin() + count;
+		return std::find_if(vertices.begin(), end,
 			[=](const ST::SimplexVertex& element)
 			{
 				return (vertex.result - element.result).lengthSquare() < epsilon;
 			})
-			!= std::end(vertices);
+			!= end;
+	}
+
+	size_t SimplexVertexArray::size() const
+	{
+		return count;
+	}
+
+	bool SimplexVertexArray::isFull() const
+	{
+		return count == Capacity;
 	}
 
 	Vector2 SimplexVertexArray::lastVertex() const
 	{
-		if (vertices.size() == 2)
-			return vertices[vertices.size() - 1].result;
-		return vertices[vertices.size() - 2].result;
+		assert(count >= 2);
+		if (count == 2)
+			return vertices[count - 1].result;
+		return vertices[count - 2].result;
 	}
 
 	bool Simplex::containsOrigin(bool strict)
@@ -55,6 +55,7 @@ namespace ST
 
 		//point[0] : pointA
 		//point[1] : pointB
+		//result is point[0] - point[1], kept instead of recomputed since gjk and epa read it in every iteration
 		Vector2 point[2];
 		Vector2 result;
 		//for polygon, the index of the vertex
@@ -63,21 +64,40 @@ namespace ST
 		Index index[2];
 	};
 
+	//SimplexVertexArray shifts vertices by memmove
+	static_assert(std::is_trivially_copyable_v<SimplexVertex>);
+	//no padding, 32 bytes with float so two vertices share a cache line
+	static_assert(sizeof(SimplexVertex) == 3 * sizeof(Vector2) + 2 * sizeof(Index));
+
 	/**
-	 * \brief Simplex Vertex Array for gjk/epa test
-	 * bottleneck: frequently insert operation
+	 * \brief Simplex Vertex Array for gjk/epa test.
+	 * Vertices live in a fixed inline array of Constant::SimplexMax, insertion shifts the tail by memmove and never allocates.
 	 */
 	struct ST_API SimplexVertexArray
 	{
-		std::vector<SimplexVertex> vertices;
+		static constexpr size_t Capacity = Constant::SimplexMax;
+
+		std::array<SimplexVertex, Capacity> vertices;
+		size_t count = 0;
 		bool isContainOrigin = false;
 		bool containOrigin(bool strict = false);
 		static bool containOrigin(const SimplexVertexArray& simplex, bool strict = false);
 
-		void insert(const size_t& pos, const SimplexVertex& vertex);
-		bool contains(const SimplexVertex& vertex);
-		bool fuzzyContains(const SimplexVertex& vertex, const real& epsilon = 0.0001);
+		/**
+		 * \brief Insert vertex after pos.
+		 * \param pos
+		 * \param vertex
+		 * \return false if array is full
+		 */
+		bool insert(const size_t& pos, const SimplexVertex& vertex);
+		bool addSimplexVertex(const SimplexVertex& vertex);
+		void removeByIndex(const size_t& index);
+		void removeAll();
+		bool contains(const SimplexVertex& vertex) const;
+		bool fuzzyContains(const SimplexVertex& vertex, const real& epsilon = real(0.0001)) const;
 
+		size_t size() const;
+		bool isFull() const;
 		Vector2 lastVertex() const;
 	};
 
@@ -98,4 +118,29 @@ namespace ST
 		void removeEnd();
 		void removeAll();
 	};
+
+	/**
+	 * \brief Simplex of the last gjk call of a pair, used to warm start the next call.\n
+	 * Vertices are kept as support indices and local points, so they follow the shapes when they move.
+	 */
+	struct ST_API SimplexCache
+	{
+		struct Vertex
+		{
+			//polygon vertex index, same as SimplexVertex::index
+			Index index[2] = { UINT32_MAX, UINT32_MAX };
+			//point in local space of shape A and shape B, used when index is not a polygon vertex
+			Vector2 localPoint[2];
+		};
+
+		std::array<Vertex, 3> vertices;
+		size_t count = 0;
+		//uuid of shape A when stored, so that a pair passed in swapped order can be restored too
+		uint32_t uuidA = 0;
+
+		void clear()
+		{
+			count = 0;
+		}
+	};
 }
@@ -1,121 +1,283 @@
 #include "SweepAndPrune.h"
 
+#include "ST2D/Utility/ThreadPool.h"
+
 namespace ST
 {
-	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> SweepAndPrune::generate(const std::vector<ShapePrimitive*>& bodyList)
+	void SweepAndPrune::insert(ShapePrimitive* body)
 	{
-		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> result;
-		//sort by x axis
-		std::vector<std::pair<ShapePrimitive*, AABB>> bodyBoxPairList;
-		bodyBoxPairList.reserve(bodyList.size());
+		assert(body != nullptr);
+		if (m_bodyToMinX.contains(body))
+			return;
 
-		for (auto&& elem : bodyList)
-		{
-			AABB aabb = AABB::fromShape(*elem);
-			bodyBoxPairList.emplace_back(std::make_pair(elem, aabb));
-		}
+		Entry entry;
+		entry.body = body;
+		computeBounds(entry);
 
-		std::vector<std::pair<ShapePrimitive*, AABB>> sortXAxis = bodyBoxPairList;
-		std::vector<std::pair<ShapePrimitive*, AABB>> sortYAxis = bodyBoxPairList;
-		std::sort(sortXAxis.begin(), sortXAxis.end(), [](const std::pair<ShapePrimitive*, AABB>& left, const std::pair<ShapePrimitive*, AABB>& right)
+		//stored entries stay sorted even when their bounds are stale, so one binary search finds the position
+		auto position = std::upper_bound(m_entries.begin(), m_entries.end(), entry.minX, [](const real& minX, const Entry& other)
 			{
-				return left.second.minimumX() < right.second.minimumX();
+				return minX < other.minX;
 			});
-		std::sort(sortYAxis.begin(), sortYAxis.end(), [](const std::pair<ShapePrimitive*, AABB>& left, const std::pair<ShapePrimitive*, AABB>& right)
+		m_entries.insert(position, entry);
+		m_bodyToMinX.emplace(body, entry.minX);
+
+		buildMaxXTree();
+	}
+
+	void SweepAndPrune::remove(ShapePrimitive* body)
+	{
+		auto iter = m_bodyToMinX.find(body);
+		if (iter == m_bodyToMinX.end())
+			return;
+
+		//entries with the same minimum x are adjacent, the body is one of them
+		auto position = std::lower_bound(m_entries.begin(), m_entries.end(), iter->second, [](const Entry& other, const real& minX)
 			{
-				return left.second.minimumY() < right.second.minimumY();
+				return other.minX < minX;
 			});
+		while (position != m_entries.end() && position->body != body)
+			++position;
+		assert(position != m_entries.end());
 
+		m_entries.erase(position);
+		m_bodyToMinX.erase(iter);
+		buildMaxXTree();
+	}
 
-		std::vector<ShapePair> xPairs;
-		std::vector<ShapePair> yPairs;
+	void SweepAndPrune::clearAll()
+	{
+		m_entries.clear();
+		m_bodyToMinX.clear();
+		m_maxXTree.clear();
+		m_maxXLeafCount = 0;
+	}
 
-		for (auto before = sortXAxis.begin(); before != sortXAxis.end(); ++before)
-		{
-			for (auto next = std::next(before); next != sortXAxis.end(); ++next)
-			{
-				const real minBefore = before->second.minimumX();
-				const real maxBefore = before->second.maximumX();
-				const real minNext = next->second.minimumX();
-				const real maxNext = next->second.maximumX();
+	void SweepAndPrune::update()
+	{
+		m_bodies.resize(m_entries.size());
+		for (size_t i = 0; i < m_entries.size(); ++i)
+			m_bodies[i] = m_entries[i].body;
 
-				if (!(maxBefore < minNext || maxNext < minBefore))
-				{
-					xPairs.emplace_back(ShapePair::makeShapePair(before->first, next->first));
-				}
-				else
-					break;
-			}
+		AABB::fromShapes(m_bodies, m_bounds);
+		for (size_t i = 0; i < m_entries.size(); ++i)
+		{
+			Entry& entry = m_entries[i];
+			entry.minX = m_bounds.minimumX[i];
+			entry.maxX = m_bounds.maximumX[i];
+			entry.minY = m_bounds.minimumY[i];
+			entry.maxY = m_bounds.maximumY[i];
+			m_bodyToMinX[entry.body] = entry.minX;
 		}
 
-		for (auto before = sortYAxis.begin(); before != sortYAxis.end(); ++before)
-		{
-			for (auto next = std::next(before); next != sortYAxis.end(); ++next)
-			{
-				const real minBefore = before->second.minimumY();
-				const real maxBefore = before->second.maximumY();
-				const real minNext = next->second.minimumY();
-				const real maxNext = next->second.maximumY();
+		sortEntries();
+		m_isDirty = false;
+	}
 
-				if (!(maxBefore < minNext || maxNext < minBefore))
-				{
-					yPairs.emplace_back(ShapePair::makeShapePair(before->first, next->first));
-				}
-				else
-					break;
-			}
-		}
+	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> SweepAndPrune::generate() const
+	{
+		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> result;
+		ThreadPool& pool = ThreadPool::instance();
 
-		std::sort(xPairs.begin(), xPairs.end(), [](const ShapePair& left, const ShapePair& right)
-			{
-				return left.id < right.id;
-			});
-		std::sort(yPairs.begin(), yPairs.end(), [](const ShapePair& left, const ShapePair& right)
+		//Every chunk owns the pairs whose left body lies inside the chunk.
+		//The inner sweep is allowed to run past the end of the chunk, so overlaps straddling a chunk boundary
+		//are reported exactly once, by the chunk holding the body with the smaller minimum x.
+		std::vector<std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>>> buffers(pool.concurrency());
+		const size_t chunkCount = pool.parallelFor(m_entries.size(), ParallelGrainSize,
+			[this, &buffers](size_t begin, size_t end, size_t chunkIndex)
 			{
-				return left.id < right.id;
+				auto& local = buffers[chunkIndex];
+				for (size_t before = begin; before < end; ++before)
+				{
+					const Entry& entryBefore = m_entries[before];
+					for (size_t next = before + 1; next < m_entries.size(); ++next)
+					{
+						const Entry& entryNext = m_entries[next];
+						//sorted by minimum x, the rest of entries can not overlap on x axis
+						if (entryBefore.maxX < entryNext.minX)
+							break;
+
+						if (entryBefore.maxY < entryNext.minY || entryNext.maxY < entryBefore.minY)
+							continue;
+
+						if (ExtraData::shouldCollide(entryBefore.body->userData, entryNext.body->userData))
+							local.emplace_back(entryBefore.body, entryNext.body);
+					}
+				}
 			});
 
-		//double pointer check
-		auto xPair = xPairs.begin();
-		auto yPair = yPairs.begin();
-		while (xPair != xPairs.end() && yPair != yPairs.end())
-		{
-			if (xPair->id == yPair->id && (xPair->bodyA->userData.bitmask & xPair->bodyB->userData.bitmask))
+		//merge per-thread buffers
+		size_t total = 0;
+		for (size_t i = 0; i < chunkCount; ++i)
+			total += buffers[i].size();
+
+		result.reserve(total);
+		for (size_t i = 0; i < chunkCount; ++i)
+			result.insert(result.end(), buffers[i].begin(), buffers[i].end());
+
+		return result;
+	}
+
+	std::vector<ShapePrimitive*> SweepAndPrune::query(const AABB& region) const
+	{
+		std::vector<ShapePrimitive*> result;
+		if (m_entries.empty())
+			return result;
+
+		//entries after last start beyond region on x axis
+		const size_t last = std::upper_bound(m_entries.begin(), m_entries.end(), region.maximumX(), [](const real& value, const Entry& entry)
 			{
-				result.emplace_back(xPair->bodyA, xPair->bodyB);
-				xPair = std::next(xPair);
-				yPair = std::next(yPair);
-			}
-			else if (xPair->id > yPair->id)
-				yPair = std::next(yPair);
-			else
-				xPair = std::next(xPair);
-		}
+				return value < entry.minX;
+			}) - m_entries.begin();
 
+		//a wide entry only keeps its own path of the max tree alive, other subtrees ending before region are pruned
+		queryMaxXTree(1, 0, m_maxXLeafCount, last, region, result);
+		return result;
+	}
 
+	size_t SweepAndPrune::size() const
+	{
+		return m_entries.size();
+	}
+
+	BroadphaseType SweepAndPrune::type() const
+	{
+		return BroadphaseType::SweepAndPrune;
+	}
+
+	void SweepAndPrune::createProxy(ShapePrimitive* body)
+	{
+		insert(body);
+	}
+
+	void SweepAndPrune::moveProxy([[maybe_unused]] ShapePrimitive* body)
+	{
+		m_isDirty = true;
+	}
+
+	void SweepAndPrune::destroyProxy(ShapePrimitive* body)
+	{
+		remove(body);
+	}
+
+	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> SweepAndPrune::updatePairs()
+	{
+		if (m_isDirty)
+			update();
+		return generate();
+	}
+
+	std::vector<ShapePrimitive*> SweepAndPrune::query(const AABB& region)
+	{
+		if (m_isDirty)
+			update();
+		return std::as_const(*this).query(region);
+	}
+
+	std::vector<ShapePrimitive*> SweepAndPrune::raycast(const Vector2& start, const Vector2& direction)
+	{
+		if (m_isDirty)
+			update();
+		std::vector<ShapePrimitive*> result;
+		for (auto&& entry : m_entries)
+		{
+			const AABB aabb = AABB::fromBox({ entry.minX, entry.maxY }, { entry.maxX, entry.minY });
+			if (aabb.raycast(start, direction))
+				result.emplace_back(entry.body);
+		}
 		return result;
 	}
 
+	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> SweepAndPrune::generate(const std::vector<ShapePrimitive*>& bodyList)
+	{
+		SweepAndPrune sap;
+		sap.m_entries.resize(bodyList.size());
+		for (size_t i = 0; i < bodyList.size(); ++i)
+			sap.m_entries[i].body = bodyList[i];
+		sap.update();
+		return sap.generate();
+	}
+
 	std::vector<ShapePrimitive*> SweepAndPrune::query(const std::vector<ShapePrimitive*>& bodyList, const AABB& region)
 	{
-		std::vector<ShapePrimitive*> result;
+		SweepAndPrune sap;
+		sap.m_entries.resize(bodyList.size());
+		for (size_t i = 0; i < bodyList.size(); ++i)
+			sap.m_entries[i].body = bodyList[i];
+		sap.update();
+		return sap.query(region);
+	}
 
-		std::vector<std::pair<ShapePrimitive*, AABB>> bodyBoxPairList;
-		bodyBoxPairList.reserve(bodyList.size());
+	void SweepAndPrune::computeBounds(Entry& entry)
+	{
+		const AABB aabb = AABB::fromShape(*entry.body);
+		entry.minX = aabb.minimum.x;
+		entry.maxX = aabb.maximum.x;
+		entry.minY = aabb.minimum.y;
+		entry.maxY = aabb.maximum.y;
+	}
+
+	void SweepAndPrune::sortEntries()
+	{
+		//insertion sort, entries are almost sorted because of temporal coherence.
+		//fall back to std::sort when bodies are shuffled too much, e.g. the first frame.
+		const size_t shiftBudget = m_entries.size() * 8;
+		size_t shiftCount = 0;
+		for (size_t i = 1; i < m_entries.size() && shiftCount <= shiftBudget; ++i)
+		{
+			const Entry key = m_entries[i];
+			size_t j = i;
+			while (j > 0 && m_entries[j - 1].minX > key.minX)
+			{
+				m_entries[j] = m_entries[j - 1];
+				--j;
+			}
+			m_entries[j] = key;
+			shiftCount += i - j;
+		}
 
-		for (auto&& elem : bodyList)
+		if (shiftCount > shiftBudget)
 		{
-			AABB aabb = AABB::fromShape(*elem);
-			bodyBoxPairList.emplace_back(elem, aabb);
+			std::sort(m_entries.begin(), m_entries.end(), [](const Entry& left, const Entry& right)
+				{
+					return left.minX < right.minX;
+				});
 		}
 
-		//brute search
-		for (auto&& elem : bodyBoxPairList)
-			if (region.collide(elem.second))
-				result.emplace_back(elem.first);
+		buildMaxXTree();
+	}
+
+	void SweepAndPrune::buildMaxXTree()
+	{
+		m_maxXLeafCount = 1;
+		while (m_maxXLeafCount < m_entries.size())
+			m_maxXLeafCount <<= 1;
+
+		m_maxXTree.assign(m_maxXLeafCount * 2, Constant::NegativeMin);
+		for (size_t i = 0; i < m_entries.size(); ++i)
+			m_maxXTree[m_maxXLeafCount + i] = m_entries[i].maxX;
+		for (size_t i = m_maxXLeafCount - 1; i > 0; --i)
+			m_maxXTree[i] = Math::max(m_maxXTree[2 * i], m_maxXTree[2 * i + 1]);
+	}
 
+	void SweepAndPrune::queryMaxXTree(size_t node, size_t begin, size_t width, size_t last, const AABB& region,
+		std::vector<ShapePrimitive*>& result) const
+	{
+		//subtree starts beyond region, or every entry of it ends before region
+		if (begin >= last || m_maxXTree[node] < region.minimumX())
+			return;
 
+		if (width == 1)
+		{
+			const Entry& entry = m_entries[begin];
+			if (entry.maxY < region.minimumY() || region.maximumY() < entry.minY)
+				return;
+			result.emplace_back(entry.body);
+			return;
+		}
 
-		return result;
+		const size_t half = width / 2;
+		queryMaxXTree(node * 2, begin, half, last, region, result);
+		queryMaxXTree(node * 2 + 1, begin + half, half, last, region, result);
 	}
 }
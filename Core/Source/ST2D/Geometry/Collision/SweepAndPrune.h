@@ -1,15 +1,79 @@
 #pragma once
 
-#include "ST2D/Geometry/Shape/AABB.h"
+#include "Broadphase.h"
 
 namespace ST
 {
-	class ST_API SweepAndPrune
+	/// <summary>
+	/// Sweep And Prune on x axis.
+	///	Entries are kept sorted by minimum x between frames, so re-sorting after small movement is almost linear
+	///	and region queries only visit the entries that can overlap on x axis.
+	///	insert and remove place or erase one entry in the sorted order, they cost O(n) for shifting entries.
+	/// </summary>
+	class ST_API SweepAndPrune : public Broadphase
 	{
 	public:
+		void insert(ShapePrimitive* body);
+		void remove(ShapePrimitive* body);
+		void clearAll() override;
+		/// <summary>
+		/// Recompute AABB of every body and restore the sorted order. Call this after bodies are moved.
+		/// </summary>
+		void update();
+		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> generate() const;
+		/// <summary>
+		/// Binary search the sorted entries and descend a max tree of maximum x,
+		/// cost O((k + 1) log n) where k is the count of entries overlapping region on x axis.
+		/// </summary>
+		/// <param name="region"></param>
+		/// <returns></returns>
+		std::vector<ShapePrimitive*> query(const AABB& region) const;
+		size_t size() const;
+
+		BroadphaseType type() const override;
+		void createProxy(ShapePrimitive* body) override;
+		/// <summary>
+		/// Entries are refreshed together on the next updatePairs/query/raycast.
+		/// </summary>
+		/// <param name="body"></param>
+		void moveProxy(ShapePrimitive* body) override;
+		void destroyProxy(ShapePrimitive* body) override;
+		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> updatePairs() override;
+		std::vector<ShapePrimitive*> query(const AABB& region) override;
+		std::vector<ShapePrimitive*> raycast(const Vector2& start, const Vector2& direction) override;
 
 		static std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> generate(const std::vector<ShapePrimitive*>& bodyList);
 		static std::vector<ShapePrimitive*> query(const std::vector<ShapePrimitive*>& bodyList, const AABB& region);
+
+		//minimum count of bodies swept by one worker thread
+		static constexpr size_t ParallelGrainSize = 256;
+
+	private:
+		struct Entry
+		{
+			ShapePrimitive* body = nullptr;
+			real minX = 0;
+			real maxX = 0;
+			real minY = 0;
+			real maxY = 0;
+		};
+
+		static void computeBounds(Entry& entry);
+		void sortEntries();
+		void buildMaxXTree();
+		void queryMaxXTree(size_t node, size_t begin, size_t width, size_t last, const AABB& region,
+			std::vector<ShapePrimitive*>& result) const;
+
+		std::vector<Entry> m_entries;
+		//scratch buffers of update, kept to avoid reallocation every frame
+		std::vector<ShapePrimitive*> m_bodies;
+		AABBBuffer m_bounds;
+		//minimum x of every entry as stored in m_entries, locates the entry of a body by binary search
+		std::unordered_map<ShapePrimitive*, real> m_bodyToMinX;
+		//implicit complete binary tree over sorted entries, node i holds the maximum of maxX below it.
+		//Root is 1, children of i are 2i and 2i+1, leaves start at m_maxXLeafCount and are padded with NegativeMin
+		std::vector<real> m_maxXTree;
+		size_t m_maxXLeafCount = 0;
+		bool m_isDirty = false;
 	};
 }
-
@@ -26,9 +26,12 @@ namespace ST
 	{
 		body = nullptr;
 		aabb.clear();
+		bodyAABB.clear();
 		parentIndex = -1;
 		leftIndex = -1;
 		rightIndex = -1;
+		categoryBits = 0;
+		maskBits = 0;
 	}
 
 	Tree::Tree()
@@ -65,12 +68,51 @@ namespace ST
 	}
 
 
+	BroadphaseType Tree::type() const
+	{
+		return BroadphaseType::Tree;
+	}
+
+	void Tree::createProxy(ShapePrimitive* body)
+	{
+		insert(body);
+	}
+
+	void Tree::moveProxy(ShapePrimitive* body)
+	{
+		update(body);
+	}
+
+	void Tree::moveProxies(const std::vector<ShapePrimitive*>& bodies)
+	{
+		AABB::fromShapes(bodies, m_bounds);
+		for (size_t i = 0; i < bodies.size(); ++i)
+			update(bodies[i], m_bounds.at(i));
+	}
+
+	void Tree::destroyProxy(ShapePrimitive* body)
+	{
+		remove(body);
+	}
+
+	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> Tree::updatePairs()
+	{
+		return generate();
+	}
+
 	void Tree::insert(ShapePrimitive* body)
+	{
+		insert(body, AABB::fromShape(*body));
+	}
+
+	void Tree::insert(ShapePrimitive* body, const AABB& bodyAABB)
 	{
 		int newNodeIndex = allocateNode();
 		m_tree[newNodeIndex].body = body;
-		m_tree[newNodeIndex].aabb = AABB::fromShape(*body);
+		m_tree[newNodeIndex].bodyAABB = bodyAABB;
+		m_tree[newNodeIndex].aabb = bodyAABB;
 		m_tree[newNodeIndex].aabb.expand(m_fatExpansionFactor);
+		setLeafFilter(newNodeIndex);
 		m_bodyTable[body] = newNodeIndex;
 		if (m_rootIndex == -1)
 		{
@@ -132,17 +174,30 @@ namespace ST
 	}
 
 	void Tree::update(ShapePrimitive* body)
+	{
+		update(body, AABB::fromShape(*body));
+	}
+
+	void Tree::update(ShapePrimitive* body, const AABB& bodyAABB)
 	{
 		auto iter = m_bodyTable.find(body);
 		if (iter == m_bodyTable.end())
 			return;
 
-		AABB thin = AABB::fromShape(*body);
-		thin.expand(0.1f);
+		//filter of body may be changed at runtime
+		const uint32_t categoryBits = m_tree[iter->second].categoryBits;
+		const uint32_t maskBits = m_tree[iter->second].maskBits;
+		setLeafFilter(iter->second);
+		if (categoryBits != m_tree[iter->second].categoryBits || maskBits != m_tree[iter->second].maskBits)
+			upgrade(m_tree[iter->second].parentIndex);
+
+		m_tree[iter->second].bodyAABB = bodyAABB;
+		AABB thin = bodyAABB;
+		thin.expand(real(0.1));
 		if (!thin.isSubset(m_tree[iter->second].aabb))
 		{
 			extract(iter->second);
-			insert(body);
+			insert(body, bodyAABB);
 		}
 	}
 
@@ -160,8 +215,8 @@ namespace ST
 	{
 		if (nodeIndex == -1)
 			return;
-		const bool overlap = m_tree[nodeIndex].aabb.collide(aabb) || m_tree[nodeIndex].aabb.isSubset(aabb)
-			|| aabb.isSubset(m_tree[nodeIndex].aabb);
+		//containment implies overlap of closed boxes
+		const bool overlap = m_tree[nodeIndex].aabb.collide(aabb);
 
 		if (!overlap)
 			return;
@@ -231,15 +286,15 @@ namespace ST
 		}
 
 		real area = m_tree[boxIndex].aabb.surfaceArea();
-		real unionArea = AABB::unite(m_tree[nodeIndex].aabb, m_tree[boxIndex].aabb).surfaceArea();
+		real unionArea = AABB::combine(m_tree[nodeIndex].aabb, m_tree[boxIndex].aabb).surfaceArea();
 
-		cost = 2.0f * area;
-		real inheritanceCost = 2.0f * (unionArea - area);
+		cost = 2 * area;
+		real inheritanceCost = 2 * (unionArea - area);
 
 		auto accumulateCost = [&](int nodeIndex, int boxIndex)
 			{
 				if (m_tree[nodeIndex].isLeaf())
-					return inheritanceCost + AABB::unite(m_tree[nodeIndex].aabb, m_tree[boxIndex].aabb).surfaceArea();
+					return inheritanceCost + AABB::combine(m_tree[nodeIndex].aabb, m_tree[boxIndex].aabb).surfaceArea();
 				return deltaCost(nodeIndex, boxIndex) + inheritanceCost;
 			};
 
@@ -275,17 +330,18 @@ namespace ST
 		if (nodeIndex < 0)
 			return;
 
-		if (m_tree[nodeIndex].aabb.raycast(p, d))
+		if (!m_tree[nodeIndex].aabb.raycast(p, d))
+			return;
+
+		if (m_tree[nodeIndex].isLeaf())
 		{
-			AABB aabb = AABB::fromShape(*m_tree[nodeIndex].body);
-			if (m_tree[nodeIndex].isLeaf() && aabb.raycast(p, d))
+			//branch node has no body, test tight AABB of leaf only
+			if (m_tree[nodeIndex].bodyAABB.raycast(p, d))
 				result.emplace_back(m_tree[nodeIndex].body);
-			else
-			{
-				raycast(result, m_tree[nodeIndex].leftIndex, p, d);
-				raycast(result, m_tree[nodeIndex].rightIndex, p, d);
-			}
+			return;
 		}
+		raycast(result, m_tree[nodeIndex].leftIndex, p, d);
+		raycast(result, m_tree[nodeIndex].rightIndex, p, d);
 	}
 
 	void Tree::generate(int nodeIndex, std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>>& pairs)
@@ -309,20 +365,21 @@ namespace ST
 		if (leftIndex < 0 || rightIndex < 0)
 			return;
 
-		bool result = m_tree[leftIndex].aabb.collide(m_tree[rightIndex].aabb) || m_tree[leftIndex].aabb.isSubset(m_tree[rightIndex].aabb)
-			|| m_tree[rightIndex].aabb.isSubset(m_tree[leftIndex].aabb);
+		bool result = m_tree[leftIndex].aabb.collide(m_tree[rightIndex].aabb);
 
 		if (!result)
 			return;
 
+		//no body in left subtree accepts any body in right subtree
+		if (!canCollide(leftIndex, rightIndex))
+			return;
+
 		if (m_tree[leftIndex].isLeaf() && m_tree[rightIndex].isLeaf())
 		{
-			auto bitmask1 = m_tree[leftIndex].body->userData.bitmask;
-			auto bitmask2 = m_tree[leftIndex].body->userData.bitmask;
-			if (bitmask1 & bitmask2)
+			if (ExtraData::shouldCollide(m_tree[leftIndex].body->userData, m_tree[rightIndex].body->userData))
 			{
 				//if AABB of A & B overlap
-				if (AABB::fromShape(*m_tree[leftIndex].body).collide(AABB::fromShape(*m_tree[rightIndex].body)))
+				if (m_tree[leftIndex].bodyAABB.collide(m_tree[rightIndex].bodyAABB))
 				{
 					std::pair pair = { m_tree[leftIndex].body, m_tree[rightIndex].body };
 					pairs.emplace_back(pair);
@@ -379,7 +436,8 @@ namespace ST
 		m_tree[nodeIndex].parentIndex = parentIndex;
 		m_tree[parentIndex].leftIndex = leafIndex;
 		m_tree[parentIndex].rightIndex = nodeIndex;
-		m_tree[parentIndex].aabb = AABB::unite(m_tree[nodeIndex].aabb, m_tree[leafIndex].aabb);
+		m_tree[parentIndex].aabb = AABB::combine(m_tree[nodeIndex].aabb, m_tree[leafIndex].aabb);
+		uniteFilter(parentIndex);
 		return parentIndex;
 
 	}
@@ -548,7 +606,7 @@ namespace ST
 	}
 	real Tree::totalCost(int nodeIndex, int leafIndex)
 	{
-		real totalCost = AABB::unite(m_tree[nodeIndex].aabb, m_tree[leafIndex].aabb).surfaceArea();
+		real totalCost = AABB::combine(m_tree[nodeIndex].aabb, m_tree[leafIndex].aabb).surfaceArea();
 		int currentIndex = m_tree[leafIndex].parentIndex;
 		while (currentIndex != -1)
 		{
@@ -562,13 +620,14 @@ namespace ST
 		if (nodeIndex < 0 || m_tree[nodeIndex].isLeaf())
 			return;
 
-		m_tree[nodeIndex].aabb = AABB::unite(m_tree[m_tree[nodeIndex].leftIndex].aabb, m_tree[m_tree[nodeIndex].rightIndex].aabb);
+		m_tree[nodeIndex].aabb = AABB::combine(m_tree[m_tree[nodeIndex].leftIndex].aabb, m_tree[m_tree[nodeIndex].rightIndex].aabb);
+		uniteFilter(nodeIndex);
 
 		upgrade(m_tree[nodeIndex].parentIndex);
 	}
 	real Tree::deltaCost(int nodeIndex, int boxIndex)
 	{
-		return AABB::unite(m_tree[boxIndex].aabb, m_tree[nodeIndex].aabb).surfaceArea() - m_tree[boxIndex].aabb.surfaceArea();
+		return AABB::combine(m_tree[boxIndex].aabb, m_tree[nodeIndex].aabb).surfaceArea() - m_tree[boxIndex].aabb.surfaceArea();
 	}
 	size_t Tree::allocateNode()
 	{
@@ -582,6 +641,34 @@ namespace ST
 		return m_tree.size() - 1;
 	}
 
+	void Tree::setLeafFilter(int leafIndex)
+	{
+		const ExtraData& data = m_tree[leafIndex].body->userData;
+		m_tree[leafIndex].categoryBits = data.categoryBits;
+		m_tree[leafIndex].maskBits = data.maskBits;
+		//positive group overrides category and mask, never prune it
+		if (data.groupIndex > 0)
+		{
+			m_tree[leafIndex].categoryBits = 0xFFFFFFFF;
+			m_tree[leafIndex].maskBits = 0xFFFFFFFF;
+		}
+	}
+
+	void Tree::uniteFilter(int nodeIndex)
+	{
+		const Node& left = m_tree[m_tree[nodeIndex].leftIndex];
+		const Node& right = m_tree[m_tree[nodeIndex].rightIndex];
+		m_tree[nodeIndex].categoryBits = left.categoryBits | right.categoryBits;
+		m_tree[nodeIndex].maskBits = left.maskBits | right.maskBits;
+	}
+
+	bool Tree::canCollide(int leftIndex, int rightIndex) const
+	{
+		const Node& left = m_tree[leftIndex];
+		const Node& right = m_tree[rightIndex];
+		return (left.maskBits & right.categoryBits) != 0 && (right.maskBits & left.categoryBits) != 0;
+	}
+
 	int Tree::height(int targetIndex)
 	{
 		return targetIndex < 0 ? 0 : std::max(height(m_tree[targetIndex].leftIndex), height(m_tree[targetIndex].rightIndex)) + 1;
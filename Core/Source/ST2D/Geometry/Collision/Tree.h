@@ -1,6 +1,6 @@
 #pragma once
 
-#include "ST2D/Geometry/Shape/AABB.h"
+#include "Broadphase.h"
 
 namespace ST
 {
@@ -8,16 +8,21 @@ namespace ST
 	/// Dynamic Bounding Volume Tree
 	///	This is implemented by dynamic array-arranged.
 	/// </summary>
-	class ST_API Tree
+	class ST_API Tree : public Broadphase
 	{
 	public:
 		struct ST_API Node
 		{
 			ShapePrimitive* body = nullptr;
 			AABB aabb;
+			//tight AABB of body, valid for leaf only
+			AABB bodyAABB;
 			int parentIndex = -1;
 			int leftIndex = -1;
 			int rightIndex = -1;
+			//union of collision filter in this subtree, used to prune pair generation
+			uint32_t categoryBits = 0;
+			uint32_t maskBits = 0;
 			bool isLeaf()const;
 			bool isBranch()const;
 			bool isRoot()const;
@@ -27,18 +32,27 @@ namespace ST
 		};
 		Tree();
 		std::vector<ShapePrimitive*> query(ShapePrimitive* body);
-		std::vector<ShapePrimitive*> query(const AABB& aabb);
-		std::vector<ShapePrimitive*> raycast(const Vector2& point, const Vector2& direction);
+		std::vector<ShapePrimitive*> query(const AABB& aabb) override;
+		std::vector<ShapePrimitive*> raycast(const Vector2& point, const Vector2& direction) override;
 		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> generate();
 
 		void insert(ShapePrimitive* body);
 		void remove(ShapePrimitive* body);
-		void clearAll();
+		void clearAll() override;
 		void update(ShapePrimitive* body);
+
+		BroadphaseType type() const override;
+		void createProxy(ShapePrimitive* body) override;
+		void moveProxy(ShapePrimitive* body) override;
+		void moveProxies(const std::vector<ShapePrimitive*>& bodies) override;
+		void destroyProxy(ShapePrimitive* body) override;
+		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> updatePairs() override;
 		const std::vector<Node>& tree();
 		int rootIndex()const;
 
 	private:
+		void insert(ShapePrimitive* body, const AABB& bodyAABB);
+		void update(ShapePrimitive* body, const AABB& bodyAABB);
 		void queryNodes(int nodeIndex, const AABB& aabb, std::vector<ShapePrimitive*>& result);
 		void traverseLowestCost(int nodeIndex, int boxIndex, real& cost, int& finalIndex);
 		void raycast(std::vector<ShapePrimitive*>& result, int nodeIndex, const Vector2& p, const Vector2& d);
@@ -58,13 +72,17 @@ namespace ST
 		real totalCost(int nodeIndex, int leafIndex);
 		real deltaCost(int nodeIndex, int boxIndex);
 		size_t allocateNode();
+		void setLeafFilter(int leafIndex);
+		void uniteFilter(int nodeIndex);
+		bool canCollide(int leftIndex, int rightIndex) const;
 		int height(int targetIndex);
 
-		real m_fatExpansionFactor = 0.5f;
+		real m_fatExpansionFactor = real(0.5);
 		int m_rootIndex = -1;
 		std::vector<Node> m_tree;
 		std::vector<int> m_emptyList;
 		std::map<ShapePrimitive*, int> m_bodyTable;
+		AABBBuffer m_bounds;
 	};
 
 
@@ -20,6 +20,8 @@ namespace ST
 				{
 					for (auto iterInner = iterOuter + 1; iterInner != cell.second.end(); ++iterInner)
 					{
+						if (!ExtraData::shouldCollide((*iterOuter)->userData, (*iterInner)->userData))
+							continue;
 						auto uuid1 = (*iterInner)->userData.uuid;
 						auto uuid2 = (*iterOuter)->userData.uuid;
 						map[mixPairUUID(uuid1, uuid2)] = std::make_pair(
@@ -30,8 +32,8 @@ namespace ST
 		}
 		for (auto&& elem : map)
 		{
-			AABB aabb1 = AABB::fromShape(*elem.second.first);
-			AABB aabb2 = AABB::fromShape(*elem.second.second);
+			const AABB& aabb1 = m_bodiesToAABB[elem.second.first];
+			const AABB& aabb2 = m_bodiesToAABB[elem.second.second];
 			if (aabb1.collide(aabb2))
 				result.emplace_back(elem.second);
 		}
@@ -41,13 +43,31 @@ namespace ST
 	std::vector<ShapePrimitive*> UniformGrid::raycast(const Vector2& p, const Vector2& d)
 	{
 		std::vector<ShapePrimitive*> result;
+		for (auto&& elem : queryCells(p, d))
+		{
+			auto iter = m_cellsToBodies.find(elem);
+			if (iter != m_cellsToBodies.end())
+				for (auto&& body : iter->second)
+					result.emplace_back(body);
+		}
+		//body may be registered in several cells
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+
+		std::erase_if(result, [this, &p, &d](ShapePrimitive* body)
+			{
+				return !m_bodiesToAABB[body].raycast(p, d);
+			});
 		return result;
 	}
 
 	void UniformGrid::updateAll()
 	{
+		std::vector<ShapePrimitive*> bodies;
+		bodies.reserve(m_bodiesToCells.size());
 		for (auto&& elem : m_bodiesToCells)
-			update(elem.first);
+			bodies.emplace_back(elem.first);
+		moveProxies(bodies);
 	}
 
 	void UniformGrid::update(ShapePrimitive* body)
@@ -59,12 +79,17 @@ namespace ST
 	void UniformGrid::insert(ShapePrimitive* body)
 	{
 		assert(body != nullptr);
+		insert(body, AABB::fromShape(*body));
+	}
+
+	void UniformGrid::insert(ShapePrimitive* body, const AABB& aabb)
+	{
 		auto iter = m_bodiesToCells.find(body);
 		if (iter != m_bodiesToCells.end())
 			return;
-		AABB aabb = AABB::fromShape(*body);
 		auto cells = queryCells(aabb);
 		m_bodiesToCells[body] = cells;
+		m_bodiesToAABB[body] = aabb;
 		for (auto&& elem : cells)
 			m_cellsToBodies[elem].emplace_back(body);
 	}
@@ -75,11 +100,23 @@ namespace ST
 		auto iter = m_bodiesToCells.find(body);
 		if (iter == m_bodiesToCells.end())
 			return;
+		for (auto&& elem : iter->second)
+		{
+			auto cell = m_cellsToBodies.find(elem);
+			if (cell == m_cellsToBodies.end())
+				continue;
+			std::erase(cell->second, body);
+			if (cell->second.empty())
+				m_cellsToBodies.erase(cell);
+		}
+		m_bodiesToCells.erase(iter);
+		m_bodiesToAABB.erase(body);
 	}
 
 	void UniformGrid::clearAll()
 	{
 		m_bodiesToCells.clear();
+		m_bodiesToAABB.clear();
 		m_cellsToBodies.clear();
 	}
 
@@ -94,10 +131,45 @@ namespace ST
 				for (auto&& body : iter->second)
 					result.emplace_back(body);
 		}
+		//body may be registered in several cells
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
 
 		return result;
 	}
 
+	BroadphaseType UniformGrid::type() const
+	{
+		return BroadphaseType::UniformGrid;
+	}
+
+	void UniformGrid::createProxy(ShapePrimitive* body)
+	{
+		insert(body);
+	}
+
+	void UniformGrid::moveProxy(ShapePrimitive* body)
+	{
+		update(body);
+	}
+
+	void UniformGrid::moveProxies(const std::vector<ShapePrimitive*>& bodies)
+	{
+		AABB::fromShapes(bodies, m_bounds);
+		for (size_t i = 0; i < bodies.size(); ++i)
+			incrementalUpdate(bodies[i], m_bounds.at(i));
+	}
+
+	void UniformGrid::destroyProxy(ShapePrimitive* body)
+	{
+		remove(body);
+	}
+
+	std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> UniformGrid::updatePairs()
+	{
+		return generate();
+	}
+
 	int UniformGrid::rows() const
 	{
 		return m_rows;
@@ -182,14 +254,19 @@ namespace ST
 	void UniformGrid::incrementalUpdate(ShapePrimitive* body)
 	{
 		assert(body != nullptr);
+		incrementalUpdate(body, AABB::fromShape(*body));
+	}
+
+	void UniformGrid::incrementalUpdate(ShapePrimitive* body, const AABB& aabb)
+	{
 		auto iter = m_bodiesToCells.find(body);
 		if (iter == m_bodiesToCells.end())
 			return;
+		m_bodiesToAABB[body] = aabb;
 		//Incremental update
 		//cell list must be sorted array
 		auto oldCellList = m_bodiesToCells[body];
 
-		AABB aabb = AABB::fromShape(*body);
 		auto newCellList = queryCells(aabb);
 
 		std::sort(oldCellList.begin(), oldCellList.end(), std::less<Position>());
@@ -276,8 +353,8 @@ namespace ST
 	{
 		std::vector<Position> cells;
 		//locate x axis
-		const real halfWidth = m_width * 0.5f;
-		const real halfHeight = m_height * 0.5f;
+		const real halfWidth = m_width * real(0.5);
+		const real halfHeight = m_height * real(0.5);
 		const real xRealMin = aabb.minimumX();
 		const real xRealMax = aabb.maximumX();
 		const real xMin = Math::clamp(xRealMin, -halfWidth, halfWidth - m_cellWidth);
@@ -297,9 +374,9 @@ namespace ST
 		if (lowerYIndex == upperYIndex && yRealMax < -halfHeight || yRealMin > halfHeight)
 			return cells;
 
-		for (real i = lowerXIndex; i <= upperXIndex; i += 1.0f)
+		for (real i = lowerXIndex; i <= upperXIndex; i += 1)
 		{
-			for (real j = lowerYIndex; j <= upperYIndex; j += 1.0f)
+			for (real j = lowerYIndex; j <= upperYIndex; j += 1)
 			{
 				cells.emplace_back(Position{ static_cast<uint32_t>(i), static_cast<uint32_t>(j) });
 			}
@@ -308,6 +385,74 @@ namespace ST
 		return cells;
 	}
 
+	std::vector<UniformGrid::Position> UniformGrid::queryCells(const Vector2& start, const Vector2& direction)
+	{
+		std::vector<Position> cells;
+		if (direction.fuzzyEqual({ 0, 0 }))
+			return cells;
+
+		//clip ray by grid bounds, bodies outside grid are not registered in any cell
+		const real halfWidth = m_width * real(0.5);
+		const real halfHeight = m_height * real(0.5);
+		real tEnter = 0;
+		real tExit = Constant::Max;
+		auto clipSlab = [&tEnter, &tExit](const real& origin, const real& delta, const real& lower, const real& upper)
+			{
+				if (delta == 0)
+					return origin >= lower && origin <= upper;
+				const real t1 = (lower - origin) / delta;
+				const real t2 = (upper - origin) / delta;
+				tEnter = Math::max(tEnter, Math::min(t1, t2));
+				tExit = Math::min(tExit, Math::max(t1, t2));
+				return tEnter <= tExit;
+			};
+		if (!clipSlab(start.x, direction.x, -halfWidth, halfWidth)
+			|| !clipSlab(start.y, direction.y, -halfHeight, halfHeight))
+			return cells;
+
+		//same cell mapping as AABB query: x index is floored from 0, y index is ceiled from 1
+		const Vector2 enter = start + direction * tEnter;
+		int64_t x = static_cast<int64_t>(std::floor((enter.x + halfWidth) / m_cellWidth));
+		int64_t y = static_cast<int64_t>(std::ceil((enter.y + halfHeight) / m_cellHeight));
+		x = std::clamp<int64_t>(x, 0, static_cast<int64_t>(m_columns) - 1);
+		y = std::clamp<int64_t>(y, 1, static_cast<int64_t>(m_rows));
+
+		//walk cells by crossing the nearest cell boundary each step, refer Amanatides & Woo
+		const int64_t stepX = direction.x > 0 ? 1 : (direction.x < 0 ? -1 : 0);
+		const int64_t stepY = direction.y > 0 ? 1 : (direction.y < 0 ? -1 : 0);
+		const real deltaX = stepX != 0 ? m_cellWidth / Math::abs(direction.x) : Constant::Max;
+		const real deltaY = stepY != 0 ? m_cellHeight / Math::abs(direction.y) : Constant::Max;
+		real nextX = Constant::Max;
+		real nextY = Constant::Max;
+		if (stepX != 0)
+			nextX = (static_cast<real>(stepX > 0 ? x + 1 : x) * m_cellWidth - halfWidth - start.x) / direction.x;
+		if (stepY != 0)
+			nextY = (static_cast<real>(stepY > 0 ? y : y - 1) * m_cellHeight - halfHeight - start.y) / direction.y;
+
+		while (true)
+		{
+			cells.emplace_back(Position{ static_cast<uint32_t>(x), static_cast<uint32_t>(y) });
+			if (nextX < nextY)
+			{
+				if (nextX > tExit)
+					break;
+				x += stepX;
+				nextX += deltaX;
+			}
+			else
+			{
+				if (nextY > tExit)
+					break;
+				y += stepY;
+				nextY += deltaY;
+			}
+			if (x < 0 || x >= static_cast<int64_t>(m_columns) || y < 1 || y > static_cast<int64_t>(m_rows))
+				break;
+		}
+
+		return cells;
+	}
+
 	real UniformGrid::cellHeight() const
 	{
 		return m_cellHeight;
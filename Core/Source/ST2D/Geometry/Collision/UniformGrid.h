@@ -1,27 +1,34 @@
 #pragma once
 
-#include "ST2D/Geometry/Shape/AABB.h"
+#include "Broadphase.h"
 
 namespace ST
 {
 	//TODO 20220704
 	//1. Incremental Update Bodies, calculating the different between two cellList
 	//2. Position combine to u64 and split into two u32
-	//3. Raycast query bodies
-	class ST_API UniformGrid
+	class ST_API UniformGrid : public Broadphase
 	{
 	public:
-		UniformGrid(const real& width = 400.0f, const real& height = 400.0f, uint32_t rows = 400,
+		UniformGrid(const real& width = 400, const real& height = 400, uint32_t rows = 400,
 			uint32_t columns = 400);
 		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> generate();
-		std::vector<ShapePrimitive*> raycast(const Vector2& p, const Vector2& d);
+		//walks the cells crossed by the ray inside grid bounds, bodies outside grid are not found like query
+		std::vector<ShapePrimitive*> raycast(const Vector2& p, const Vector2& d) override;
 
 		void updateAll();
 		void update(ShapePrimitive* body);
 		void insert(ShapePrimitive* body);
 		void remove(ShapePrimitive* body);
-		void clearAll();
-		std::vector<ShapePrimitive*> query(const AABB& aabb);
+		void clearAll() override;
+		std::vector<ShapePrimitive*> query(const AABB& aabb) override;
+
+		BroadphaseType type() const override;
+		void createProxy(ShapePrimitive* body) override;
+		void moveProxy(ShapePrimitive* body) override;
+		void moveProxies(const std::vector<ShapePrimitive*>& bodies) override;
+		void destroyProxy(ShapePrimitive* body) override;
+		std::vector<std::pair<ShapePrimitive*, ShapePrimitive*>> updatePairs() override;
 
 
 		int rows() const;
@@ -92,18 +99,24 @@ namespace ST
 			Delete
 		};
 
+		void insert(ShapePrimitive* body, const AABB& aabb);
+		void incrementalUpdate(ShapePrimitive* body, const AABB& aabb);
 		void updateGrid();
 		void changeGridSize();
 		void updateBodies();
 		std::vector<std::pair<Operation, Position>> compareCellList(
 			const std::vector<Position>& oldCellList, const std::vector<Position>& newCellList);
-		real m_width = 100.0f;
-		real m_height = 100.0f;
+		real m_width = 100;
+		real m_height = 100;
 		uint32_t m_rows = 200;
 		uint32_t m_columns = 200;
 
 
-		real m_cellWidth = 0.0f;
-		real m_cellHeight = 0.0f;
+		//tight AABB of every registered body, refreshed when the body is updated
+		std::map<ShapePrimitive*, AABB> m_bodiesToAABB;
+		AABBBuffer m_bounds;
+
+		real m_cellWidth = 0;
+		real m_cellHeight = 0;
 	};
 }
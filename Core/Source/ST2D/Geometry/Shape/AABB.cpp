@@ -3,77 +3,166 @@
 #include "Ellipse.h"
 #include "Circle.h"
 #include "Edge.h"
+#include "Capsule.h"
+#include "ShapeCache.h"
 #include "Rectangle.h"
 #include "ST2D/Geometry/Algorithms/Algorithm2D.h"
 #include "ST2D/Geometry/Collision/Narrowphase.h"
+#include "ST2D/Utility/ThreadPool.h"
 
 namespace ST
 {
+	//minimum count of shapes computed by one worker thread in AABB::fromShapes
+	static constexpr size_t AABBBatchGrainSize = 128;
 
-	bool AABB::isEmpty() const
-	{
-		return realEqual(width, 0) && realEqual(height, 0) && position.fuzzyEqual({ 0, 0 });
-	}
-	bool AABB::raycast(const Vector2& start, const Vector2& direction) const
-	{
-		return raycast(*this, start, direction);
-	}
-
-	AABB::AABB(const Vector2& topLeft, const real& boxWidth, const real& boxHeight)
-	{
-		this->width = boxWidth;
-		this->height = boxHeight;
-		this->position = topLeft + Vector2(boxWidth * 0.5f, -boxHeight * 0.5f);
-	}
-
-	AABB::AABB(const Vector2& topLeft, const Vector2& bottomRight)
+	//rotate local vertices and reduce them to min/max, two float vertices per register
+	static void polygonBounds(const std::vector<Vector2>& vertices, const real& c, const real& s,
+		real& minX, real& minY, real& maxX, real& maxY)
 	{
-		*this = fromBox(topLeft, bottomRight);
-	}
-
-	Vector2 AABB::topLeft() const
-	{
-		return Vector2{ minimumX() , maximumY() };
-	}
-
-	Vector2 AABB::topRight() const
-	{
-		return Vector2{ maximumX(), maximumY() };
-	}
-
-	Vector2 AABB::bottomLeft() const
-	{
-		return Vector2{ minimumX() , minimumY() };
-	}
-
-	Vector2 AABB::bottomRight() const
-	{
-		return Vector2{ maximumX() , minimumY() };
+		assert(!vertices.empty());
+#ifdef ST_DOUBLE_PRECISION
+		//one vertex {x, y} per register
+		static_assert(sizeof(Vector2) == 2 * sizeof(double), "vertices must be packed double pairs");
+		const __m128d cos2 = _mm_set1_pd(c);
+		const __m128d sin2 = _mm_setr_pd(-s, s);
+		__m128d low = _mm_set1_pd(Constant::Max);
+		__m128d high = _mm_set1_pd(Constant::NegativeMin);
+
+		const double* data = &vertices[0].x;
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const __m128d xy = _mm_loadu_pd(data + 2 * i);
+			const __m128d yx = _mm_shuffle_pd(xy, xy, 1);
+			const __m128d rotated = _mm_add_pd(_mm_mul_pd(xy, cos2), _mm_mul_pd(yx, sin2));
+			low = _mm_min_pd(low, rotated);
+			high = _mm_max_pd(high, rotated);
+		}
+		alignas(16) double lowLanes[2];
+		alignas(16) double highLanes[2];
+		_mm_store_pd(lowLanes, low);
+		_mm_store_pd(highLanes, high);
+		minX = lowLanes[0];
+		minY = lowLanes[1];
+		maxX = highLanes[0];
+		maxY = highLanes[1];
+#else
+		static_assert(sizeof(Vector2) == 2 * sizeof(float), "vertices must be packed float pairs");
+		const __m128 cos4 = _mm_set1_ps(c);
+		//x' = c * x - s * y, y' = s * x + c * y
+		const __m128 sin4 = _mm_setr_ps(-s, s, -s, s);
+		__m128 low = _mm_set1_ps(Constant::Max);
+		__m128 high = _mm_set1_ps(Constant::NegativeMin);
+
+		const size_t count = vertices.size();
+		const float* data = &vertices[0].x;
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m128 xy = _mm_loadu_ps(data + 2 * i);
+			const __m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1));
+			const __m128 rotated = _mm_add_ps(_mm_mul_ps(xy, cos4), _mm_mul_ps(yx, sin4));
+			low = _mm_min_ps(low, rotated);
+			high = _mm_max_ps(high, rotated);
+		}
+		if (i < count)
+		{
+			const __m128 xy = _mm_setr_ps(data[2 * i], data[2 * i + 1], data[2 * i], data[2 * i + 1]);
+			const __m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1));
+			const __m128 rotated = _mm_add_ps(_mm_mul_ps(xy, cos4), _mm_mul_ps(yx, sin4));
+			low = _mm_min_ps(low, rotated);
+			high = _mm_max_ps(high, rotated);
+		}
+		//fold lanes {x0, y0, x1, y1} into {x, y}
+		low = _mm_min_ps(low, _mm_movehl_ps(low, low));
+		high = _mm_max_ps(high, _mm_movehl_ps(high, high));
+		alignas(16) float lowLanes[4];
+		alignas(16) float highLanes[4];
+		_mm_store_ps(lowLanes, low);
+		_mm_store_ps(highLanes, high);
+		minX = lowLanes[0];
+		minY = lowLanes[1];
+		maxX = highLanes[0];
+		maxY = highLanes[1];
+#endif
 	}
 
-	real AABB::minimumX() const
+	//write bounds of one shape relative to its transform position.
+	//Only polygon is SIMD, other shapes are a few multiplies after sin/cos of rotation
+	static void shapeBounds(const ShapePrimitive& shape, real& minX, real& minY, real& maxX, real& maxY)
 	{
-		return -width * 0.5f + position.x;
+		const real c = Math::cosx(shape.transform.rotation);
+		const real s = Math::sinx(shape.transform.rotation);
+		real halfX = 0;
+		real halfY = 0;
+		switch (shape.shape->type())
+		{
+		case ShapeType::Polygon:
+		{
+			const Polygon* polygon = static_cast<Polygon*>(shape.shape);
+			polygonBounds(polygon->vertices(), c, s, minX, minY, maxX, maxY);
+			return;
+		}
+		case ShapeType::Ellipse:
+		{
+			//extents of rotated ellipse: sqrt(a^2 * cos^2 + b^2 * sin^2)
+			const Ellipse* ellipse = static_cast<Ellipse*>(shape.shape);
+			const real a2 = ellipse->A() * ellipse->A();
+			const real b2 = ellipse->B() * ellipse->B();
+			halfX = std::sqrt(a2 * c * c + b2 * s * s);
+			halfY = std::sqrt(a2 * s * s + b2 * c * c);
+			break;
+		}
+		case ShapeType::Circle:
+		{
+			halfX = halfY = static_cast<Circle*>(shape.shape)->radius();
+			break;
+		}
+		case ShapeType::Edge:
+		{
+			//same as fromShape: edge vertices are not rotated
+			const Edge* edge = static_cast<Edge*>(shape.shape);
+			minX = Math::min(edge->startPoint().x, edge->endPoint().x) - real(0.25);
+			maxX = Math::max(edge->startPoint().x, edge->endPoint().x) + real(0.25);
+			minY = Math::min(edge->startPoint().y, edge->endPoint().y) - real(0.25);
+			maxY = Math::max(edge->startPoint().y, edge->endPoint().y) + real(0.25);
+			return;
+		}
+		case ShapeType::Capsule:
+		{
+			//extents of rotated segment plus radius
+			const Capsule* capsule = static_cast<Capsule*>(shape.shape);
+			const real radius = Math::min(capsule->halfWidth(), capsule->halfHeight());
+			const real length = Math::abs(capsule->halfWidth() - capsule->halfHeight());
+			const bool isHorizontal = capsule->halfWidth() >= capsule->halfHeight();
+			halfX = length * Math::abs(isHorizontal ? c : s) + radius;
+			halfY = length * Math::abs(isHorizontal ? s : c) + radius;
+			break;
+		}
+		}
+		minX = -halfX;
+		maxX = halfX;
+		minY = -halfY;
+		maxY = halfY;
 	}
 
-	real AABB::minimumY() const
+	bool AABB::isEmpty() const
 	{
-		return -height * 0.5f + position.y;
+		return minimum.fuzzyEqual({ 0, 0 }) && maximum.fuzzyEqual({ 0, 0 });
 	}
-
-	real AABB::maximumX() const
+	bool AABB::raycast(const Vector2& start, const Vector2& direction) const
 	{
-		return width * 0.5f + position.x;
+		return raycast(*this, start, direction);
 	}
 
-	real AABB::maximumY() const
+	AABB::AABB(const Vector2& topLeft, const real& boxWidth, const real& boxHeight)
 	{
-		return height * 0.5f + position.y;
+		minimum.set(topLeft.x, topLeft.y - boxHeight);
+		maximum.set(topLeft.x + boxWidth, topLeft.y);
 	}
 
-	bool AABB::collide(const AABB& other) const
+	AABB::AABB(const Vector2& topLeft, const Vector2& bottomRight)
 	{
-		return collide(*this, other);
+		*this = fromBox(topLeft, bottomRight);
 	}
 
 	void AABB::expand(const real& factor)
@@ -83,16 +172,16 @@ namespace ST
 
 	void AABB::scale(const real& factor)
 	{
-		width *= factor;
-		height *= factor;
+		const Vector2 middle = center();
+		minimum = (minimum - middle) * factor + middle;
+		maximum = (maximum - middle) * factor + middle;
 	}
 
 
 	void AABB::clear()
 	{
-		position.clear();
-		width = 0.0;
-		height = 0.0;
+		minimum.clear();
+		maximum.clear();
 	}
 
 	AABB& AABB::unite(const AABB& other)
@@ -101,16 +190,6 @@ namespace ST
 		return *this;
 	}
 
-	real AABB::surfaceArea() const
-	{
-		return (width + height) * 2.0f;
-	}
-
-	real AABB::volume() const
-	{
-		return width * height;
-	}
-
 	bool AABB::isSubset(const AABB& other) const
 	{
 		return isSubset(other, *this);
@@ -118,119 +197,86 @@ namespace ST
 
 	bool AABB::operator==(const AABB& other) const
 	{
-		return position.fuzzyEqual(other.position) &&
-			realEqual(width, other.width) && realEqual(height, other.height);
+		return minimum.fuzzyEqual(other.minimum) && maximum.fuzzyEqual(other.maximum);
 	}
 
 	AABB AABB::fromShape(const ShapePrimitive& shape, const real& factor)
 	{
-		AABB aabb;
-		switch (shape.shape->type())
-		{
-		case ShapeType::Polygon:
+		if (const ShapeCache* cache = shape.validCache())
 		{
-			const Polygon* polygon = static_cast<Polygon*>(shape.shape);
-			real max_x = Constant::NegativeMin, max_y = Constant::NegativeMin, min_x = Constant::Max, min_y = Constant::Max;
-			for (const Vector2& v : polygon->vertices())
-			{
-				const Vector2 vertex = Matrix2x2(shape.transform.rotation).multiply(v);
-				if (max_x < vertex.x)
-					max_x = vertex.x;
-
-				if (min_x > vertex.x)
-					min_x = vertex.x;
-
-				if (max_y < vertex.y)
-					max_y = vertex.y;
-
-				if (min_y > vertex.y)
-					min_y = vertex.y;
-			}
-			aabb.width = std::fabs(max_x - min_x);
-			aabb.height = std::fabs(max_y - min_y);
-			aabb.position.set((max_x + min_x) * 0.5f, (max_y + min_y) * 0.5f);
-			break;
+			AABB aabb = cache->aabb;
+			aabb.expand(factor);
+			return aabb;
 		}
-		case ShapeType::Ellipse:
-		{
-			const Ellipse* ellipse = static_cast<Ellipse*>(shape.shape);
 
-			Vector2 top_dir{ 0, 1 };
-			Vector2 left_dir{ -1, 0 };
-			Vector2 bottom_dir{ 0, -1 };
-			Vector2 right_dir{ 1, 0 };
+		AABB aabb;
+		shapeBounds(shape, aabb.minimum.x, aabb.minimum.y, aabb.maximum.x, aabb.maximum.y);
+		aabb.minimum += shape.transform.position;
+		aabb.maximum += shape.transform.position;
+		aabb.expand(factor);
+		return aabb;
+	}
 
-			top_dir = Matrix2x2(-shape.transform.rotation).multiply(top_dir);
-			left_dir = Matrix2x2(-shape.transform.rotation).multiply(left_dir);
-			bottom_dir = Matrix2x2(-shape.transform.rotation).multiply(bottom_dir);
-			right_dir = Matrix2x2(-shape.transform.rotation).multiply(right_dir);
+	void AABB::fromShapes(const std::vector<ShapePrimitive*>& shapes, AABBBuffer& buffer, const real& factor)
+	{
+		buffer.resize(shapes.size());
+		const real half = factor * real(0.5);
+		ThreadPool::instance().parallelFor(shapes.size(), AABBBatchGrainSize, [&](size_t begin, size_t end, size_t)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					const ShapePrimitive& shape = *shapes[i];
+					if (const ShapeCache* cache = shape.validCache())
+					{
+						buffer.minimumX[i] = cache->aabb.minimum.x - half;
+						buffer.minimumY[i] = cache->aabb.minimum.y - half;
+						buffer.maximumX[i] = cache->aabb.maximum.x + half;
+						buffer.maximumY[i] = cache->aabb.maximum.y + half;
+						continue;
+					}
+					real minX, minY, maxX, maxY;
+					shapeBounds(shape, minX, minY, maxX, maxY);
+					buffer.minimumX[i] = minX + shape.transform.position.x - half;
+					buffer.minimumY[i] = minY + shape.transform.position.y - half;
+					buffer.maximumX[i] = maxX + shape.transform.position.x + half;
+					buffer.maximumY[i] = maxY + shape.transform.position.y + half;
+				}
+			});
+	}
 
-			Vector2 top = GeometryAlgorithm2D::calculateEllipseProjectionPoint(ellipse->A(), ellipse->B(), top_dir);
-			Vector2 left = GeometryAlgorithm2D::calculateEllipseProjectionPoint(ellipse->A(), ellipse->B(), left_dir);
-			Vector2 bottom = GeometryAlgorithm2D::calculateEllipseProjectionPoint(ellipse->A(), ellipse->B(), bottom_dir);
-			Vector2 right = GeometryAlgorithm2D::calculateEllipseProjectionPoint(ellipse->A(), ellipse->B(), right_dir);
+	void AABBBuffer::resize(size_t size)
+	{
+		minimumX.resize(size);
+		minimumY.resize(size);
+		maximumX.resize(size);
+		maximumY.resize(size);
+	}
 
-			top = Matrix2x2(shape.transform.rotation).multiply(top);
-			left = Matrix2x2(shape.transform.rotation).multiply(left);
-			bottom = Matrix2x2(shape.transform.rotation).multiply(bottom);
-			right = Matrix2x2(shape.transform.rotation).multiply(right);
+	size_t AABBBuffer::size() const
+	{
+		return minimumX.size();
+	}
 
-			aabb.height = std::fabs(top.y - bottom.y);
-			aabb.width = std::fabs(right.x - left.x);
-			break;
-		}
-		case ShapeType::Circle:
-		{
-			const Circle* circle = static_cast<Circle*>(shape.shape);
-			aabb.width = circle->radius() * 2;
-			aabb.height = circle->radius() * 2;
-			break;
-		}
-		case ShapeType::Edge:
-		{
-			const Edge* edge = static_cast<Edge*>(shape.shape);
-			aabb.width = std::fabs(edge->startPoint().x - edge->endPoint().x);
-			aabb.height = std::fabs(edge->startPoint().y - edge->endPoint().y);
-			aabb.position.set(edge->startPoint().x + edge->endPoint().x, edge->startPoint().y + edge->endPoint().y);
-			aabb.position *= 0.5f;
-			aabb.expand(0.5f);
-			break;
-		}
-		case ShapeType::Capsule:
-		{
-			auto [p1, idx1] = Narrowphase::findFurthestPoint(shape, { 1, 0 });
-			auto [p2, idx2] = Narrowphase::findFurthestPoint(shape, { 0, 1 });
-			p1 -= shape.transform.position;
-			p2 -= shape.transform.position;
-			aabb.width = p1.x * 2.0f;
-			aabb.height = p2.y * 2.0f;
-			break;
-		}
-		}
-		aabb.position += shape.transform.position;
-		aabb.expand(factor);
+	AABB AABBBuffer::at(size_t index) const
+	{
+		assert(index < size());
+		AABB aabb;
+		aabb.minimum.set(minimumX[index], minimumY[index]);
+		aabb.maximum.set(maximumX[index], maximumY[index]);
 		return aabb;
 	}
 
-
 	AABB AABB::fromBox(const Vector2& topLeft, const Vector2& bottomRight)
 	{
 		AABB result;
-		result.width = bottomRight.x - topLeft.x;
-		result.height = topLeft.y - bottomRight.y;
-		result.position = (topLeft + bottomRight) * 0.5f;
+		result.minimum.set(topLeft.x, bottomRight.y);
+		result.maximum.set(bottomRight.x, topLeft.y);
 		return result;
 	}
 
 	bool AABB::collide(const AABB& src, const AABB& target)
 	{
-		const Vector2 srcTopLeft = src.topLeft();
-		const Vector2 srcBottomRight = src.bottomRight();
-
-		const Vector2 targetTopLeft = target.topLeft();
-		const Vector2 targetBottomRight = target.bottomRight();
-
-		return !(srcBottomRight.x < targetTopLeft.x || targetBottomRight.x < srcTopLeft.x || srcTopLeft.y < targetBottomRight.y || targetTopLeft.y < srcBottomRight.y);
+		return src.collide(target);
 	}
 
 	AABB AABB::unite(const AABB& src, const AABB& target, const real& factor)
@@ -241,24 +287,7 @@ namespace ST
 		if (target.isEmpty())
 			return src;
 
-
-		const Vector2 srcTopLeft = src.topLeft();
-		const Vector2 srcBottomRight = src.bottomRight();
-
-		const Vector2 targetTopLeft = target.topLeft();
-		const Vector2 targetBottomRight = target.bottomRight();
-
-		const real low_x = Math::min(srcTopLeft.x, targetTopLeft.x);
-		const real high_x = Math::max(srcBottomRight.x, targetBottomRight.x);
-
-		const real low_y = Math::min(srcBottomRight.y, targetBottomRight.y);
-		const real high_y = Math::max(srcTopLeft.y, targetTopLeft.y);
-
-		AABB aabb;
-		aabb.position.set((low_x + high_x) * 0.5f, (low_y + high_y) * 0.5f);
-		aabb.width = high_x - low_x;
-		aabb.height = high_y - low_y;
-
+		AABB aabb = combine(src, target);
 		aabb.expand(factor);
 		return aabb;
 	}
@@ -266,19 +295,16 @@ namespace ST
 	bool AABB::isSubset(const AABB& a, const AABB& b)
 	{
 
-		const Vector2 aTopLeft = a.topLeft();
-		const Vector2 aBottomRight = a.bottomRight();
-
-		const Vector2 bTopLeft = b.topLeft();
-		const Vector2 bBottomRight = b.bottomRight();
-
-		return aBottomRight.x >= bBottomRight.x && bTopLeft.x >= aTopLeft.x &&
-			aTopLeft.y >= bTopLeft.y && bBottomRight.y >= aBottomRight.y;
+		return (a.minimum.x <= b.minimum.x) & (b.maximum.x <= a.maximum.x)
+			& (a.minimum.y <= b.minimum.y) & (b.maximum.y <= a.maximum.y);
 	}
 	void AABB::expand(AABB& aabb, const real& factor)
 	{
-		aabb.width += factor;
-		aabb.height += factor;
+		const real half = factor * real(0.5);
+		aabb.minimum.x -= half;
+		aabb.minimum.y -= half;
+		aabb.maximum.x += half;
+		aabb.maximum.y += half;
 	}
 	bool AABB::raycast(const AABB& aabb, const Vector2& start, const Vector2& direction)
 	{
@@ -4,15 +4,20 @@
 
 namespace ST
 {
+	struct AABBBuffer;
 
 	struct ST_API AABB
 	{
 		AABB() = default;
 		AABB(const Vector2& topLeft, const real& boxWidth, const real& boxHeight);
 		AABB(const Vector2& topLeft, const Vector2& bottomRight);
-		real width = 0;
-		real height = 0;
-		Vector2 position;
+		//lower left and upper right corner
+		Vector2 minimum;
+		Vector2 maximum;
+
+		inline real width()const;
+		inline real height()const;
+		inline Vector2 center()const;
 		inline Vector2 topLeft()const;
 		inline Vector2 topRight()const;
 		inline Vector2 bottomLeft()const;
@@ -23,13 +28,14 @@ namespace ST
 		inline real maximumX()const;
 		inline real maximumY()const;
 
-		bool collide(const AABB& other) const;
+		inline bool collide(const AABB& other) const;
+		inline bool contains(const Vector2& point) const;
 		void expand(const real& factor);
 		void scale(const real& factor);
 		void clear();
 		AABB& unite(const AABB& other);
-		real surfaceArea()const;
-		real volume()const;
+		inline real surfaceArea()const;
+		inline real volume()const;
 		bool isSubset(const AABB& other)const;
 		bool isEmpty()const;
 		bool operator==(const AABB& other)const;
@@ -41,6 +47,13 @@ namespace ST
 		/// <param name="factor">AABB scale factor. Default factor 1 means making tight AABB</param>
 		/// <returns></returns>
 		static AABB fromShape(const ShapePrimitive& shape, const real& factor = 0);
+		/// <summary>
+		/// Batch version of fromShape. AABB of shapes[i] is written into slot i of buffer.
+		/// </summary>
+		/// <param name="shapes">shape sources</param>
+		/// <param name="buffer">output, resized to the count of shapes</param>
+		/// <param name="factor">AABB scale factor, same as fromShape</param>
+		static void fromShapes(const std::vector<ShapePrimitive*>& shapes, AABBBuffer& buffer, const real& factor = 0);
 
 		static AABB fromBox(const Vector2& topLeft, const Vector2& bottomRight);
 		/// <summary>
@@ -51,13 +64,20 @@ namespace ST
 		/// <returns></returns>
 		static bool collide(const AABB& src, const AABB& target);
 		/// <summary>
-		/// Return two aabb union result
+		/// Return two aabb union result. Empty aabb is treated as identity.
 		/// </summary>
 		/// <param name="src"></param>
 		/// <param name="target"></param>
 		/// <returns></returns>
 		static AABB unite(const AABB& src, const AABB& target, const real& factor = 0);
 		/// <summary>
+		/// Union of two non-empty aabbs without the empty check of unite, used on hot paths like tree cost.
+		/// </summary>
+		/// <param name="src"></param>
+		/// <param name="target"></param>
+		/// <returns></returns>
+		static inline AABB combine(const AABB& src, const AABB& target);
+		/// <summary>
 		/// Check if b is subset of a
 		/// </summary>
 		/// <param name="a"></param>
@@ -71,5 +91,107 @@ namespace ST
 
 	};
 
+	inline real AABB::width() const
+	{
+		return maximum.x - minimum.x;
+	}
+
+	inline real AABB::height() const
+	{
+		return maximum.y - minimum.y;
+	}
+
+	inline Vector2 AABB::center() const
+	{
+		return Vector2((minimum.x + maximum.x) * real(0.5), (minimum.y + maximum.y) * real(0.5));
+	}
+
+	inline Vector2 AABB::topLeft() const
+	{
+		return Vector2(minimum.x, maximum.y);
+	}
+
+	inline Vector2 AABB::topRight() const
+	{
+		return maximum;
+	}
+
+	inline Vector2 AABB::bottomLeft() const
+	{
+		return minimum;
+	}
+
+	inline Vector2 AABB::bottomRight() const
+	{
+		return Vector2(maximum.x, minimum.y);
+	}
+
+	inline real AABB::minimumX() const
+	{
+		return minimum.x;
+	}
+
+	inline real AABB::minimumY() const
+	{
+		return minimum.y;
+	}
+
+	inline real AABB::maximumX() const
+	{
+		return maximum.x;
+	}
+
+	inline real AABB::maximumY() const
+	{
+		return maximum.y;
+	}
+
+	inline bool AABB::collide(const AABB& other) const
+	{
+		//non-short-circuit and, compiled to compares without branches
+		return (minimum.x <= other.maximum.x) & (other.minimum.x <= maximum.x)
+			& (minimum.y <= other.maximum.y) & (other.minimum.y <= maximum.y);
+	}
+
+	inline bool AABB::contains(const Vector2& point) const
+	{
+		return (minimum.x <= point.x) & (point.x <= maximum.x)
+			& (minimum.y <= point.y) & (point.y <= maximum.y);
+	}
+
+	inline real AABB::surfaceArea() const
+	{
+		return (maximum.x - minimum.x + maximum.y - minimum.y) * 2;
+	}
+
+	inline real AABB::volume() const
+	{
+		return (maximum.x - minimum.x) * (maximum.y - minimum.y);
+	}
+
+	inline AABB AABB::combine(const AABB& src, const AABB& target)
+	{
+		AABB aabb;
+		aabb.minimum.x = Math::min(src.minimum.x, target.minimum.x);
+		aabb.minimum.y = Math::min(src.minimum.y, target.minimum.y);
+		aabb.maximum.x = Math::max(src.maximum.x, target.maximum.x);
+		aabb.maximum.y = Math::max(src.maximum.y, target.maximum.y);
+		return aabb;
+	}
+
+	/// <summary>
+	/// Structure of arrays storage of min/max bounds, filled by AABB::fromShapes.
+	/// </summary>
+	struct ST_API AABBBuffer
+	{
+		std::vector<real> minimumX;
+		std::vector<real> minimumY;
+		std::vector<real> maximumX;
+		std::vector<real> maximumY;
+
+		void resize(size_t size);
+		size_t size()const;
+		AABB at(size_t index)const;
+	};
 
 }
\ No newline at end of file
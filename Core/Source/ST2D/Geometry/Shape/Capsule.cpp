@@ -3,7 +3,7 @@
 namespace ST
 {
 
-	Capsule::Capsule(real width, real height) : m_halfWidth(width / 2.0f), m_halfHeight(height / 2.0f)
+	Capsule::Capsule(real width, real height) : m_halfWidth(width / 2), m_halfHeight(height / 2)
 	{
 		m_type = ShapeType::Capsule;
 	}
@@ -53,28 +53,28 @@ namespace ST
 
 	void Capsule::set(real width, real height)
 	{
-		m_halfWidth = width / 2.0f;
-		m_halfHeight = height / 2.0f;
+		m_halfWidth = width / 2;
+		m_halfHeight = height / 2;
 	}
 
 	void Capsule::setWidth(real width)
 	{
-		m_halfWidth = width * 2.0f;
+		m_halfWidth = width * 2;
 	}
 
 	void Capsule::setHeight(real height)
 	{
-		m_halfHeight = height * 2.0f;
+		m_halfHeight = height * 2;
 	}
 
 	real Capsule::width()const
 	{
-		return 2.0f * m_halfWidth;
+		return 2 * m_halfWidth;
 	}
 
 	real Capsule::height()const
 	{
-		return 2.0f * m_halfHeight;
+		return 2 * m_halfHeight;
 	}
 
 	real Capsule::halfWidth() const
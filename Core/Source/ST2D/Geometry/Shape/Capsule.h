@@ -7,7 +7,7 @@ namespace ST
     class ST_API Capsule : public Shape
     {
     public:
-        Capsule(real width = 0.0f, real height = 0.0f);
+        Capsule(real width = 0, real height = 0);
         bool contains(const Vector2& point, const real& epsilon) override;
         void scale(const real& factor) override;
         Vector2 center() const override;
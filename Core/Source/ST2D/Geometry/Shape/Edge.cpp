@@ -48,7 +48,7 @@ namespace ST
 
 	Vector2 Edge::center()const
 	{
-		return (m_point[0] + m_point[1]) / 2.0f;
+		return (m_point[0] + m_point[1]) / 2;
 	}
 
 	Vector2 Edge::normal() const
@@ -42,7 +42,7 @@ namespace ST
 		assert(!realEqual(a, 0) && !realEqual(b, 0));
 		const real x = m_width > m_height ? point.x : point.y;
 		const real y = m_width > m_height ? point.y : point.x;
-		return (x / a) * (x / a) + (y / b) * (y / b) <= 1.0f;
+		return (x / a) * (x / a) + (y / b) * (y / b) <= 1;
 	}
 
 	Vector2 Ellipse::center() const
@@ -62,12 +62,12 @@ namespace ST
 
 	real Ellipse::A() const
 	{
-		return m_width > m_height ? m_width / 2.0f : m_height / 2.0f;
+		return m_width > m_height ? m_width / 2 : m_height / 2;
 	}
 
 	real Ellipse::B() const
 	{
-		return m_width > m_height ? m_height / 2.0f : m_width / 2.0f;
+		return m_width > m_height ? m_height / 2 : m_width / 2;
 	}
 
 	real Ellipse::C() const
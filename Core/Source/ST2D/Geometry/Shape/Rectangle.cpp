@@ -49,9 +49,9 @@ namespace ST
 	void Rectangle::calcVertices()
 	{
 		m_vertices.clear();
-		m_vertices.emplace_back(Vector2(-m_width * (0.5f), m_height * (0.5f)));
-		m_vertices.emplace_back(Vector2(-m_width * (0.5f), -m_height * (0.5f)));
-		m_vertices.emplace_back(Vector2(m_width * (0.5f), -m_height * (0.5f)));
-		m_vertices.emplace_back(Vector2(m_width * (0.5f), m_height * (0.5f)));
+		m_vertices.emplace_back(Vector2(-m_width * real(0.5), m_height * real(0.5)));
+		m_vertices.emplace_back(Vector2(-m_width * real(0.5), -m_height * real(0.5)));
+		m_vertices.emplace_back(Vector2(m_width * real(0.5), -m_height * real(0.5)));
+		m_vertices.emplace_back(Vector2(m_width * real(0.5), m_height * real(0.5)));
 	}
 }
\ No newline at end of file
@@ -39,7 +39,7 @@ namespace ST
 		//refer https://docs.unity3d.com/ScriptReference/Transform.html
 		Vector2 position;
 		real rotation = 0;
-		real scale = 1.0f;
+		real scale = 1;
 
 		Vector2 translatePoint(const Vector2& source) const
 		{
@@ -55,15 +55,57 @@ namespace ST
 		{
 			return Matrix2x2(-rotation).multiply(point);
 		}
+
+		//exact comparison, any movement counts as a change
+		bool operator==(const Transform& other) const
+		{
+			return position.x == other.position.x && position.y == other.position.y
+				&& rotation == other.rotation && scale == other.scale;
+		}
+	};
+
+	/// <summary>
+	/// Motion of a transform over one step, linearly interpolated by t in [0, 1].
+	/// </summary>
+	struct ST_API Sweep
+	{
+		Transform start;
+		Transform end;
+
+		Transform at(const real& t) const
+		{
+			Transform result;
+			result.position = Vector2::lerp(start.position, end.position, t);
+			result.rotation = start.rotation + (end.rotation - start.rotation) * t;
+			result.scale = start.scale + (end.scale - start.scale) * t;
+			return result;
+		}
 	};
 
 	struct ST_API ExtraData
 	{
-		uint32_t bitmask;
+		//collision filter, refer box2d b2Filter
+		//the category this body belongs to
+		uint32_t categoryBits = 0x0001;
+		//the categories this body accepts to collide with
+		uint32_t maskBits = 0xFFFFFFFF;
+		//bodies in the same positive group always collide, in the same negative group never collide.
+		//0 means no group, fall back to category and mask test
+		int32_t groupIndex = 0;
 		uint32_t uuid;
 		void* data = nullptr;
+
+		static bool shouldCollide(const ExtraData& a, const ExtraData& b)
+		{
+			if (a.groupIndex == b.groupIndex && a.groupIndex != 0)
+				return a.groupIndex > 0;
+
+			return (a.maskBits & b.categoryBits) != 0 && (b.maskBits & a.categoryBits) != 0;
+		}
 	};
 
+	struct ShapeCache;
+
 	/**
 	 * \brief Basic Shape Description Primitive. Including shape and transform.
 	 */
@@ -73,13 +115,29 @@ namespace ST
 		ExtraData userData;
 		Shape* shape = nullptr;
 		Transform transform;
-
-		bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) const
-		{
-			if (shape == nullptr)
-				return false;
-			return shape->contains(transform.inverseTranslatePoint(point), epsilon);
-		}
+		//optional world space data, null by default. Copies of primitive share the same cache.
+		std::shared_ptr<ShapeCache> cache;
+
+		bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) const;
+
+		/**
+		 * \brief Allocate world space cache. It stays invalid until the first updateCache.
+		 */
+		void enableCache();
+		void disableCache();
+		/**
+		 * \brief Rebuild cache if transform or shape pointer has been changed since last update.\n
+		 * This is the only function that writes cache, call it once per step before collision queries,
+		 * then readers on other threads never race with it.
+		 * Modifying the shape itself, e.g. Shape::scale or Polygon::append, is not detected and validCache
+		 * keeps returning the old data, so call it with force = true afterwards.
+		 */
+		void updateCache(bool force = false);
+		/**
+		 * \brief Return cache when it matches current transform and shape, otherwise nullptr
+		 * and the caller falls back to computing from local shape.
+		 */
+		const ShapeCache* validCache() const;
 	};
 
 
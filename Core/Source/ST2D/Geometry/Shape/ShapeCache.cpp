@@ -0,0 +1,88 @@
+#include "ShapeCache.h"
+
+#include "Polygon.h"
+
+namespace ST
+{
+	bool ShapeCache::isUpToDate(const ShapePrimitive& primitive) const
+	{
+		return isValid && shape == primitive.shape && transform == primitive.transform;
+	}
+
+	void ShapeCache::rebuild(const ShapePrimitive& primitive)
+	{
+		//stay invalid while rebuilding, so AABB::fromShape below computes from local shape
+		isValid = false;
+		vertices.clear();
+		normals.clear();
+
+		if (primitive.shape->type() == ShapeType::Polygon)
+		{
+			const Polygon* polygon = static_cast<const Polygon*>(primitive.shape);
+			const size_t count = polygon->vertices().size();
+			vertices.reserve(count);
+			normals.reserve(count);
+			for (const Vector2& vertex : polygon->vertices())
+				vertices.emplace_back(primitive.transform.translatePoint(vertex));
+
+			//local vertices are centered at centroid, so the centroid in world space is transform position
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Vector2 edge = vertices[(i + 1) % count] - vertices[i];
+				Vector2 normal = edge.perpendicular().normal();
+				if (normal.dot(vertices[i] - primitive.transform.position) < 0)
+					normal.negate();
+				normals.emplace_back(normal);
+			}
+		}
+
+		aabb = AABB::fromShape(primitive);
+		transform = primitive.transform;
+		shape = primitive.shape;
+		isValid = true;
+	}
+
+	bool ShapePrimitive::contains(const Vector2& point, const real& epsilon) const
+	{
+		if (shape == nullptr)
+			return false;
+
+		const ShapeCache* world = validCache();
+		if (world != nullptr && shape->type() == ShapeType::Polygon)
+		{
+			for (size_t i = 0; i < world->vertices.size(); ++i)
+				if (world->normals[i].dot(point - world->vertices[i]) > epsilon)
+					return false;
+			return true;
+		}
+
+		return shape->contains(transform.inverseTranslatePoint(point), epsilon);
+	}
+
+	void ShapePrimitive::enableCache()
+	{
+		if (cache == nullptr)
+			cache = std::make_shared<ShapeCache>();
+	}
+
+	void ShapePrimitive::disableCache()
+	{
+		cache.reset();
+	}
+
+	void ShapePrimitive::updateCache(bool force)
+	{
+		if (cache == nullptr || shape == nullptr)
+			return;
+
+		if (force || !cache->isUpToDate(*this))
+			cache->rebuild(*this);
+	}
+
+	const ShapeCache* ShapePrimitive::validCache() const
+	{
+		if (cache == nullptr || !cache->isUpToDate(*this))
+			return nullptr;
+		return cache.get();
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "AABB.h"
+
+namespace ST
+{
+	/**
+	 * \brief World space data of ShapePrimitive, shared by gjk, epa, contact clipping and broadphase within a step.\n
+	 * Polygon vertices are transformed once instead of in every support query.
+	 */
+	struct ST_API ShapeCache
+	{
+		//transform and shape the data was built from
+		Transform transform;
+		const Shape* shape = nullptr;
+		bool isValid = false;
+
+		//polygon only, world vertices and outward normal of edge (vertices[i], vertices[i + 1])
+		std::vector<Vector2> vertices;
+		std::vector<Vector2> normals;
+		//tight AABB
+		AABB aabb;
+
+		bool isUpToDate(const ShapePrimitive& primitive) const;
+		void rebuild(const ShapePrimitive& primitive);
+	};
+}
@@ -174,7 +174,7 @@ namespace ST
 	Complex Complex::normal() const
 	{
 		Complex result(re, im);
-		if(!realEqual(result.length(), 1.0f))
+		if(!realEqual(result.length(), 1))
 			result.normalize();
 		return result;
 	}
@@ -200,8 +200,8 @@ namespace ST
 
 	Complex& Complex::clear()
 	{
-		re = 0.0f;
-		im = 0.0f;
+		re = 0;
+		im = 0;
 		return *this;
 	}
 
@@ -224,7 +224,7 @@ namespace ST
 
 	Complex& Complex::normalize()
 	{
-		float ls = length();
+		real ls = length();
 		assert(!realEqual(ls, 0));
 		re /= ls;
 		im /= ls;
@@ -270,11 +270,11 @@ namespace ST
 
 	Complex Complex::slerp(const Complex& start, const Complex& end, const real& t)
 	{
-		real realT = Math::clamp(t, 0.0f, 1.0f);
+		real realT = Math::clamp(t, 0, 1);
 		Complex nStart = start.normal();
 		Complex nEnd = end.normal();
-		float rStart = std::acos(nStart.re);
-		float rEnd = std::acos(nEnd.re);
+		real rStart = std::acos(nStart.re);
+		real rEnd = std::acos(nEnd.re);
 		return { rStart * (1 - realT) + rEnd * realT };
 	}
 
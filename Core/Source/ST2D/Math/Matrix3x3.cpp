@@ -266,7 +266,7 @@ namespace ST
 	bool Matrix3x3::invert(Matrix3x3& mat)
 	{
 		const real det = mat.determinant();
-		if (realEqual(det, 0.0f))
+		if (realEqual(det, 0))
 			return false;
 
 		const real det11 = Vector2::crossProduct(mat.column2.y, mat.column2.z, mat.column3.y, mat.column3.z);
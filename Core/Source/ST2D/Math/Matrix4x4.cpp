@@ -339,7 +339,7 @@ namespace ST
 	bool Matrix4x4::invert(Matrix4x4& mat)
 	{
 		const real det = mat.determinant();
-		if (realEqual(det, 0.0f))
+		if (realEqual(det, 0))
 			return false;
 
 		const real det11 = Matrix3x3::determinant(
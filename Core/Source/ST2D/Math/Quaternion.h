@@ -11,7 +11,7 @@ namespace ST
 		Quaternion(const real& s, const Vector3& vec3);
 		Quaternion(const Quaternion& copy) = default;
 		Quaternion(Quaternion&& copy) = default;
-		real s = 0.0f;
+		real s = 0;
 		Vector3 v;
 	};
 }
@@ -8,12 +8,6 @@ namespace ST
 		assert(!std::isnan(y));
 	}
 
-	Vector2::Vector2(const Vector2& copy) : x(copy.x), y(copy.y)
-	{
-		assert(!std::isnan(x));
-		assert(!std::isnan(y));
-	}
-
 	Vector2 Vector2::operator+(const Vector2& rhs) const
 	{
 		return Vector2(x + rhs.x, y + rhs.y);
@@ -108,15 +102,15 @@ namespace ST
 
 	Vector2& Vector2::clear()
 	{
-		x = 0.0f;
-		y = 0.0f;
+		x = 0;
+		y = 0;
 		return *this;
 	}
 
 	Vector2& Vector2::negate()
 	{
-		x *= -1.0f;
-		y *= -1.0f;
+		x *= -1;
+		y *= -1;
 		return *this;
 	}
 
@@ -129,7 +123,7 @@ namespace ST
 
 	Vector2& Vector2::normalize()
 	{
-		const real length_inv = 1.0f / std::sqrt(lengthSquare());
+		const real length_inv = 1 / std::sqrt(lengthSquare());
 		assert(!std::isinf(length_inv));
 		//
 
@@ -251,13 +245,4 @@ namespace ST
 	{
 		return Vector2(x * factor, y * factor);
 	}
-
-	Vector2& Vector2::operator=(const Vector2& copy)
-	{
-		if (&copy == this)
-			return *this;
-		x = copy.x;
-		y = copy.y;
-		return *this;
-	}
 }
@@ -7,8 +7,8 @@ namespace ST
 	struct ST_API Vector2
 	{
 		Vector2(const real& _x = 0.0, const real& _y = 0.0);
-		Vector2(const Vector2& copy);
-		Vector2& operator=(const Vector2& copy);
+		Vector2(const Vector2& copy) = default;
+		Vector2& operator=(const Vector2& copy) = default;
 		Vector2(Vector2&& other) = default;
 
 		Vector2 operator+(const Vector2& rhs) const;
@@ -87,9 +87,9 @@ namespace ST
 
 	Vector3& Vector3::clear()
 	{
-		x = 0.0f;
-		y = 0.0f;
-		z = 0.0f;
+		x = 0;
+		y = 0;
+		z = 0;
 		return *this;
 	}
 
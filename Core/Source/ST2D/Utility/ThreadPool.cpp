@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+namespace ST
+{
+	ThreadPool::ThreadPool(size_t workerCount)
+	{
+		if (workerCount == 0)
+		{
+			const size_t hardware = std::thread::hardware_concurrency();
+			workerCount = hardware > 1 ? hardware - 1 : 0;
+		}
+		m_workers.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; ++i)
+			m_workers.emplace_back([this] { workerLoop(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		for (auto&& worker : m_workers)
+			worker.join();
+	}
+
+	size_t ThreadPool::concurrency() const
+	{
+		return m_workers.size() + 1;
+	}
+
+	size_t ThreadPool::parallelFor(size_t count, size_t grainSize, const RangeTask& task)
+	{
+		if (count == 0)
+			return 0;
+
+		grainSize = std::max<size_t>(grainSize, 1);
+		size_t chunkCount = std::min(concurrency(), (count + grainSize - 1) / grainSize);
+		if (chunkCount <= 1)
+		{
+			task(0, count, 0);
+			return 1;
+		}
+
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		chunkCount = (count + chunkSize - 1) / chunkSize;
+
+		std::mutex doneMutex;
+		std::condition_variable doneCondition;
+		size_t remaining = chunkCount - 1;
+
+		{
+			std::lock_guard lock(m_mutex);
+			for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+			{
+				const size_t begin = chunk * chunkSize;
+				const size_t end = std::min(begin + chunkSize, count);
+				m_tasks.emplace_back([&, begin, end, chunk]
+					{
+						task(begin, end, chunk);
+						std::lock_guard doneLock(doneMutex);
+						if (--remaining == 0)
+							doneCondition.notify_one();
+					});
+			}
+		}
+		m_condition.notify_all();
+
+		task(0, std::min(chunkSize, count), 0);
+
+		std::unique_lock doneLock(doneMutex);
+		doneCondition.wait(doneLock, [&remaining] { return remaining == 0; });
+		return chunkCount;
+	}
+
+	ThreadPool& ThreadPool::instance()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+				if (m_stop && m_tasks.empty())
+					return;
+				job = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			job();
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ST2D/Core.h"
+
+namespace ST
+{
+	/**
+	 * \brief Fixed worker thread pool for data parallel jobs.\n
+	 * parallelFor splits [0, count) into contiguous chunks and blocks until all of them are finished.
+	 * Do not call parallelFor from inside a task, nested jobs may starve the workers.
+	 */
+	class ST_API ThreadPool
+	{
+	public:
+		/**
+		 * \brief task signature: [begin, end) of the chunk and the chunk index
+		 */
+		using RangeTask = std::function<void(size_t begin, size_t end, size_t chunkIndex)>;
+
+		/**
+		 * \brief
+		 * \param workerCount number of background workers. 0 means hardware concurrency - 1
+		 */
+		explicit ThreadPool(size_t workerCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * \brief Maximum count of chunks that can run at the same time, including the calling thread.
+		 * Use this to size per-chunk buffers.
+		 * \return
+		 */
+		size_t concurrency() const;
+
+		/**
+		 * \brief Run task over [0, count). The calling thread executes the first chunk.
+		 * \param count total element count
+		 * \param grainSize minimum element count of one chunk
+		 * \param task
+		 * \return count of chunks that have been dispatched, chunk index is in [0, return value)
+		 */
+		size_t parallelFor(size_t count, size_t grainSize, const RangeTask& task);
+
+		static ThreadPool& instance();
+
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stop = false;
+	};
+}
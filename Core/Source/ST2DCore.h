@@ -15,18 +15,25 @@
 #include "ST2D/Math/Quaternion.h"
 
 #include "ST2D/Geometry/Algorithms/Algorithm2D.h"
+#include "ST2D/Geometry/Collision/Broadphase.h"
 #include "ST2D/Geometry/Collision/UniformGrid.h"
 #include "ST2D/Geometry/Collision/Simplex.h"
 #include "ST2D/Geometry/Collision/SweepAndPrune.h"
+#include "ST2D/Geometry/Collision/PairTable.h"
+#include "ST2D/Geometry/Collision/PairManager.h"
 #include "ST2D/Geometry/Collision/Narrowphase.h"
+#include "ST2D/Geometry/Collision/ContactManifold.h"
+#include "ST2D/Geometry/Collision/NarrowphaseStats.h"
 #include "ST2D/Geometry/Collision/Tree.h"
 
 #include "ST2D/Geometry/Shape/Ellipse.h"
 #include "ST2D/Geometry/Shape/AABB.h"
+#include "ST2D/Geometry/Shape/ShapeCache.h"
 #include "ST2D/Geometry/Shape/Edge.h"
 #include "ST2D/Geometry/Shape/Polygon.h"
 #include "ST2D/Geometry/Shape/Circle.h"
 #include "ST2D/Geometry/Shape/Capsule.h"
 #include "ST2D/Geometry/Shape/Rectangle.h"
 
-#include "ST2D/Utility/Easing.h"
\ No newline at end of file
+#include "ST2D/Utility/Easing.h"
+#include "ST2D/Utility/ThreadPool.h"
\ No newline at end of file
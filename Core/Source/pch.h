@@ -9,14 +9,20 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
 #include <chrono>
 
 #include <deque>
 #include <queue>
 #include <list>
+#include <unordered_map>
 #include <vector>
 #include <array>
+#include <span>
 #include <ranges>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numbers>
\ No newline at end of file
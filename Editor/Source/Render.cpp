@@ -279,7 +279,7 @@ namespace STEditor
 
 		void RenderSFMLImpl::renderAABB(sf::RenderWindow& window, Camera2D& camera, const AABB& aabb, const sf::Color& color)
 		{
-			Vector2 aabbSize(aabb.width, aabb.height);
+			Vector2 aabbSize(aabb.width(), aabb.height());
 			aabbSize *= camera.meterToPixel();
 			sf::RectangleShape shape(toVector2f(aabbSize));
 			shape.move(toVector2f(camera.worldToScreen(aabb.topLeft())));
@@ -17,10 +17,14 @@ namespace STEditor
 		sp2.transform.position.set(-1.0f, -1.0f);
 		sp1.transform.rotation = ST::Math::radians(45.0f);
 		sp2.transform.rotation = Math::radians(62);
+
+		NarrowphaseProfiler::reset();
+		NarrowphaseProfiler::setEnabled(true);
 	}
 
 	void NarrowphaseScene::onUnLoad()
 	{
+		NarrowphaseProfiler::setEnabled(false);
 	}
 
 	void NarrowphaseScene::onUpdate(float deltaTime)
@@ -34,7 +38,13 @@ namespace STEditor
 
 		RenderSFMLImpl::renderShape(window, *m_settings.camera, sp2, RenderConstant::Cyan);
 
-		auto info = Narrowphase::gjkDistance(sp1, sp2);
+		CollisionDebugInfo debugInfo;
+		auto info = Narrowphase::gjkDistance(sp1, sp2, 10, &debugInfo);
+
+		std::vector<Vector2> polytope;
+		for (auto&& element : debugInfo.polytope)
+			polytope.emplace_back(element.vertex.result);
+		RenderSFMLImpl::renderPolytope(window, *m_settings.camera, polytope, RenderConstant::LightCyan, *m_settings.font);
 
 		RenderSFMLImpl::renderPoint(window, *m_settings.camera, info.pair.pointA, RenderConstant::Yellow);
 		RenderSFMLImpl::renderPoint(window, *m_settings.camera, info.pair.pointB, RenderConstant::Cyan);
@@ -47,6 +57,73 @@ namespace STEditor
 	void NarrowphaseScene::onRenderUI()
 	{
 		AbstractScene::onRenderUI();
+
+		ImGui::Begin("Narrowphase Stats", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+#ifndef ST_ENABLE_NARROWPHASE_STATS
+		ImGui::Text("Stats are compiled out, define ST_ENABLE_NARROWPHASE_STATS to record.");
+#endif
+
+		bool isEnabled = NarrowphaseProfiler::isEnabled();
+		if (ImGui::Checkbox("Record", &isEnabled))
+			NarrowphaseProfiler::setEnabled(isEnabled);
+		ImGui::SameLine();
+		if (ImGui::Button("Reset"))
+			NarrowphaseProfiler::reset();
+
+		static const char* queryNames[NarrowphaseStats::QueryCount] = { "gjk", "epa", "gjkDistance" };
+		static const char* shapeNames[NarrowphaseStats::ShapeTypeCount] = { "Polygon", "Edge", "Capsule", "Circle", "Ellipse" };
+
+		const NarrowphaseStats stats = NarrowphaseProfiler::snapshot();
+		for (size_t query = 0; query < NarrowphaseStats::QueryCount; ++query)
+		{
+			ImGui::PushID(static_cast<int>(query));
+			ImGui::SeparatorText(queryNames[query]);
+
+			const IterationHistogram total = stats.total(static_cast<NarrowphaseQuery>(query));
+			ImGui::Text("count: %llu  mean: %.2f  max: %llu", static_cast<unsigned long long>(total.count), total.mean(),
+				static_cast<unsigned long long>(total.maxIteration));
+			ImGui::Text("converged: %llu  early exit: %llu  degenerate: %llu  limit: %llu",
+				static_cast<unsigned long long>(total.exitCount(QueryExit::Converged)),
+				static_cast<unsigned long long>(total.exitCount(QueryExit::EarlyExit)),
+				static_cast<unsigned long long>(total.exitCount(QueryExit::Degenerate)),
+				static_cast<unsigned long long>(total.exitCount(QueryExit::IterationLimit)));
+
+			std::array<float, IterationHistogram::BucketCount> buckets;
+			for (size_t i = 0; i < buckets.size(); ++i)
+				buckets[i] = static_cast<float>(total.buckets[i]);
+			ImGui::PlotHistogram("iterations", buckets.data(), static_cast<int>(buckets.size()), 0, nullptr, 0.0f,
+				FLT_MAX, ImVec2(320, 60));
+
+			if (ImGui::TreeNode("Shape Pairs"))
+			{
+				for (size_t typeA = 0; typeA < NarrowphaseStats::ShapeTypeCount; ++typeA)
+				{
+					for (size_t typeB = 0; typeB < NarrowphaseStats::ShapeTypeCount; ++typeB)
+					{
+						const IterationHistogram& histogram = stats.histograms[query][typeA][typeB];
+						if (histogram.count == 0)
+							continue;
+						ImGui::Text("%s - %s  count: %llu  mean: %.2f  max: %llu  degenerate: %llu  limit: %llu",
+							shapeNames[typeA], shapeNames[typeB], static_cast<unsigned long long>(histogram.count),
+							histogram.mean(), static_cast<unsigned long long>(histogram.maxIteration),
+							static_cast<unsigned long long>(histogram.exitCount(QueryExit::Degenerate)),
+							static_cast<unsigned long long>(histogram.exitCount(QueryExit::IterationLimit)));
+					}
+				}
+				ImGui::TreePop();
+			}
+			ImGui::PopID();
+		}
+
+		ImGui::SeparatorText("perturbSimplex");
+		for (size_t typeA = 0; typeA < NarrowphaseStats::ShapeTypeCount; ++typeA)
+			for (size_t typeB = 0; typeB < NarrowphaseStats::ShapeTypeCount; ++typeB)
+				if (stats.perturbations[typeA][typeB] > 0)
+					ImGui::Text("%s - %s: %llu", shapeNames[typeA], shapeNames[typeB],
+						static_cast<unsigned long long>(stats.perturbations[typeA][typeB]));
+
+		ImGui::End();
 	}
 
 	void NarrowphaseScene::onMousePress(sf::Event& event)